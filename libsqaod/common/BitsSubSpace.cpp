@@ -0,0 +1,47 @@
+#include "BitsSubSpace.h"
+
+using namespace sqaod;
+
+
+BitsSubSpace::BitsSubSpace() {
+    N_ = 0;
+}
+
+void BitsSubSpace::setFullSpace(SizeType N) {
+    N_ = N;
+    subPos_.resize(N);
+    for (SizeType pos = 0; pos < N; ++pos)
+        subPos_[pos] = pos;
+    base_.assign((N + 63) / 64, 0);
+}
+
+void BitsSubSpace::set(const Bits &base, const std::vector<IdxType> &subPos) {
+    for (size_t idx = 0; idx < subPos.size(); ++idx) {
+        throwErrorIf((subPos[idx] < 0) || ((IdxType)base.size <= subPos[idx]),
+                     "Bit position out of range.");
+    }
+    N_ = base.size;
+    subPos_ = subPos;
+    base_.assign((N_ + 63) / 64, 0);
+    for (SizeType pos = 0; pos < N_; ++pos) {
+        if (base(pos) != 0)
+            base_[pos >> 6] |= PackedBits(1) << (pos & 63);
+    }
+    for (size_t iPos = 0; iPos < subPos_.size(); ++iPos) {
+        IdxType pos = subPos_[iPos];
+        base_[pos >> 6] &= ~(PackedBits(1) << (pos & 63));
+    }
+}
+
+PackedBits BitsSubSpace::getNumStates() const {
+    throwErrorIf(63 < subPos_.size(), "# of enumerated bits must be less than 64.");
+    return PackedBits(1) << subPos_.size();
+}
+
+void BitsSubSpace::unpack(Bits *x, PackedBits idx) const {
+    x->resize(N_);
+    for (SizeType pos = 0; pos < N_; ++pos)
+        (*x)(pos) = (char)((base_[pos >> 6] >> (pos & 63)) & 1);
+    for (size_t iPos = 0; iPos < subPos_.size(); ++iPos)
+        (*x)(subPos_[iPos]) = (idx >> iPos) & 1;
+}
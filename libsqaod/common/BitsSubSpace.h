@@ -0,0 +1,41 @@
+/* -*- c++ -*- */
+#ifndef COMMON_BITSSUBSPACE_H__
+#define COMMON_BITSSUBSPACE_H__
+
+#include <vector>
+#include <common/Matrix.h>
+#include <common/Array.h>
+
+namespace sqaod {
+
+/* bits of any width packed to 64-bit words.  Bit pos is at (pos & 63) of word (pos >> 6). */
+typedef std::vector<PackedBits> WidePackedBits;
+
+/* sub-space of N-bit states.  Sub bits at given positions are enumerated by indices in
+ * [0, 2^nSub), in which bit i of an index is the bit at the i-th position, and other
+ * bits are those of a base state.  N is not limited, and nSub is less than 64. */
+class BitsSubSpace {
+public:
+    BitsSubSpace();
+
+    /* all bits are enumerated. */
+    void setFullSpace(SizeType N);
+
+    /* bits not in subPos are fixed to those of base. */
+    void set(const Bits &base, const std::vector<IdxType> &subPos);
+
+    /* 2^nSub, throws if nSub >= 64. */
+    PackedBits getNumStates() const;
+
+    void unpack(Bits *x, PackedBits idx) const;
+
+private:
+    SizeType N_;
+    std::vector<IdxType> subPos_;
+    /* base state, in which sub bits are 0. */
+    WidePackedBits base_;
+};
+
+}
+
+#endif
@@ -1,6 +1,9 @@
 #include "Common.h"
 #include <iostream>
 #include <float.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 
@@ -19,6 +22,22 @@ void sqaod::unpackBits(Bits *unpacked, const PackedBits packed, int N) {
         (*unpacked)(pos) = (packed >> pos) & 1;
 }
 
+int sqaod::getDefaultNumThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+int sqaod::getThreadNum() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
 
 template<class real>
 bool sqaod::isSymmetric(const MatrixType<real> &W) {
@@ -19,6 +19,29 @@ enum AnnealerState {
     annQSet = 4,
 };
 
+enum Algorithm {
+    algoDefault = 0,
+    algoNaive = 1,
+    algoLocalField = 2,
+    algoColoring = 3,
+    algoBatchSearch = 4,
+    algoGrayCode = 5,
+    algoBitPacked = 6,
+};
+
+/* order of (x, y) visited in a sweep of annealers */
+enum SweepOrder {
+    sweepRandom = 0,       /* drawn at random, default */
+    sweepSequential = 1,   /* row-major over (y, x) */
+    sweepPermutation = 2,  /* random permutation of all (y, x) per sweep */
+    sweepBlocked = 3,      /* tiles of x, and all trotters are visited in a tile */
+};
+
+/* OpenMP helpers.  They return 1 and 0 respectively if OpenMP is not enabled. */
+int getDefaultNumThreads();
+
+int getThreadNum();
+
     
 template<class real>
 void createBitsSequence(real *bits, int nBits, PackedBits bBegin, PackedBits bEnd);
@@ -0,0 +1,41 @@
+#include "AnnealMonitor.h"
+#include <float.h>
+
+using namespace sqaod;
+
+
+AnnealMonitor::AnnealMonitor() {
+    reset();
+}
+
+void AnnealMonitor::reset() {
+    stats_.nSteps = 0;
+    stats_.nFlips = 0;
+    stats_.acceptanceRate = 1.;
+    stats_.nBestUpdates = 0;
+    stats_.Ebest = DBL_MAX;
+    stats_.nFrozenSteps = 0;
+    acceptanceRates_.clear();
+}
+
+void AnnealMonitor::update(unsigned long long nFlips, unsigned long long nTrials, double E) {
+    double rate = (nTrials == 0) ? 0. : double(nFlips) / double(nTrials);
+    ++stats_.nSteps;
+    stats_.nFlips += nFlips;
+    stats_.acceptanceRate = rate;
+    acceptanceRates_.push_back(rate);
+
+    bool improved = false;
+    if (policy_.trackEnergy && (E < stats_.Ebest)) {
+        /* the first step sets Ebest, and is not counted as an improvement. */
+        improved = (stats_.Ebest != DBL_MAX);
+        stats_.Ebest = E;
+    }
+    if (improved)
+        ++stats_.nBestUpdates;
+
+    if ((rate <= policy_.maxAcceptanceRate) && !improved)
+        ++stats_.nFrozenSteps;
+    else
+        stats_.nFrozenSteps = 0;
+}
@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+#ifndef CPU_ANNEALMONITOR_H__
+#define CPU_ANNEALMONITOR_H__
+
+#include <vector>
+#include <common/Common.h>
+
+namespace sqaod {
+
+/* stopping policy of anneal().  A step is frozen if its acceptance rate is at most
+ * maxAcceptanceRate and, with trackEnergy, the best energy did not improve.  A schedule
+ * ends after nFrozenSteps consecutive frozen steps.  nFrozenSteps = 0 (default) always
+ * runs whole schedules. */
+struct StoppingPolicy {
+    StoppingPolicy() : trackEnergy(false), maxAcceptanceRate(0.), nFrozenSteps(0) { }
+
+    /* evaluates the lowest energy among trotters every step.  The dense annealer follows
+     * energies by dE of accepted flips.  The bipartite annealer sums local fields in
+     * O(N * m), and algoBitPacked costs a GEMM per step for them. */
+    bool trackEnergy;
+    double maxAcceptanceRate;
+    SizeType nFrozenSteps;
+};
+
+/* statistics of steps since the last reset, that is, of the last schedule of anneal(). */
+struct AnnealStatistics {
+    SizeType nSteps;
+    unsigned long long nFlips;
+    /* accepted / tried flips of the last step */
+    double acceptanceRate;
+    /* steps which improved the best energy, and the lowest energy among trotters
+     * seen in steps, with trackEnergy */
+    SizeType nBestUpdates;
+    double Ebest;
+    SizeType nFrozenSteps;
+};
+
+/* tracks flips and energies of annealing steps, and tells if annealing is frozen
+ * under a StoppingPolicy. */
+class AnnealMonitor {
+public:
+    AnnealMonitor();
+
+    void setPolicy(const StoppingPolicy &policy) {
+        policy_ = policy;
+    }
+
+    const StoppingPolicy &getPolicy() const {
+        return policy_;
+    }
+
+    bool tracksEnergy() const {
+        return policy_.trackEnergy;
+    }
+
+    void reset();
+
+    /* records a step which accepted nFlips of nTrials flips.  E is the lowest energy
+     * among trotters, and only read with trackEnergy. */
+    void update(unsigned long long nFlips, unsigned long long nTrials, double E = 0.);
+
+    bool isFrozen() const {
+        return (0 < policy_.nFrozenSteps) && (policy_.nFrozenSteps <= stats_.nFrozenSteps);
+    }
+
+    const AnnealStatistics &getStatistics() const {
+        return stats_;
+    }
+
+    /* acceptance rates of steps since the last reset. */
+    const std::vector<double> &getAcceptanceRates() const {
+        return acceptanceRates_;
+    }
+
+private:
+    StoppingPolicy policy_;
+    AnnealStatistics stats_;
+    std::vector<double> acceptanceRates_;
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "BoltzmannTable.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace sqaod;
+
+
+template<class real>
+BoltzmannTable<real>::BoltzmannTable() {
+    scale_ = real(0.);
+    maxK_ = width_ = 0;
+    table_ = NULL;
+    twoDivM_ = coef_ = kT_ = real(0.);
+}
+
+template<class real>
+BoltzmannTable<real>::~BoltzmannTable() {
+    delete [] table_;
+}
+
+template<class real>
+bool BoltzmannTable<real>::set(const EigenRowVector &h, const EigenMatrix &J) {
+    delete [] table_;
+    table_ = NULL;
+    maxK_ = width_ = 0;
+
+    for (int scale = 4; scale <= maxScale; scale *= 2) {
+        bool integral = true;
+        double maxK = 0.;
+        for (IdxType r = 0; integral && (r < IdxType(J.rows())); ++r) {
+            double v = double(h(r)) * scale;
+            integral = (v == std::floor(v));
+            double sum = std::fabs(v);
+            for (IdxType c = 0; integral && (c < IdxType(J.cols())); ++c) {
+                v = double(J(r, c)) * scale;
+                integral = (v == std::floor(v));
+                sum += std::fabs(v);
+            }
+            maxK = std::max(maxK, sum);
+        }
+        if (!integral)
+            continue;
+        if (maxMaxK < maxK)
+            return false;
+        scale_ = real(scale);
+        maxK_ = std::max(int(maxK), 1);
+        width_ = 2 * maxK_ + 1;
+        return true;
+    }
+    return false;
+}
+
+template<class real>
+bool BoltzmannTable<real>::build(real twoDivM, real coef, real kT, int nProposals) {
+    if (!isSet() || (clearsPerExp * nProposals < 3 * width_))
+        return false;
+    if (table_ == NULL)
+        table_ = new real[3 * width_];
+    twoDivM_ = twoDivM;
+    coef_ = coef;
+    kT_ = kT;
+    /* negative entries are not evaluated yet. */
+    std::fill(table_, table_ + 3 * width_, real(-1.));
+    return true;
+}
+
+template<class real>
+bool BoltzmannTable<real>::buildAll(real twoDivM, real coef, real kT, int nProposals) {
+    if (!isSet() || (nProposals < 3 * width_))
+        return false;
+    build(twoDivM, coef, kT, nProposals);
+    for (int nbSum = -2; nbSum <= 2; nbSum += 2) {
+        real *row = &table_[(nbSum / 2 + 1) * width_];
+        for (int k = - maxK_; k <= maxK_; ++k)
+            row[k + maxK_] = evaluate(k, nbSum);
+    }
+    return true;
+}
+
+template<class real>
+real BoltzmannTable<real>::evaluate(int k, int nbSum) const {
+    real dE = - twoDivM_ * (real(k) / scale_);
+    dE -= real(nbSum) * coef_;
+    return (dE < real(0.)) ? real(1.) : std::exp(-dE / kT_);
+}
+
+template class sqaod::BoltzmannTable<float>;
+template class sqaod::BoltzmannTable<double>;
@@ -0,0 +1,74 @@
+/* -*- c++ -*- */
+#ifndef CPU_BOLTZMANNTABLE_H__
+#define CPU_BOLTZMANNTABLE_H__
+
+#include <common/Common.h>
+
+namespace sqaod {
+
+/* acceptance thresholds of flips for fields, field(x) = h(x) + J.row(x) * q, which are
+ * integral in units of 1 / scale, as in QUBOs of integral W (scale = 4).
+ * For a flip of q(y, x),
+ *   dE = - twoDivM * k / scale - t * coef,
+ *   k = q(y, x) * scale * field(x) in [-maxK, maxK],
+ *   t = q(y, x) * (q(y - 1, x) + q(y + 1, x)) in {-2, 0, 2},
+ * thus exp(-dE / kT) is tabulated per (G, kT), and dE is computed in the same way
+ * as annealers do to give the same thresholds.  maxK bounds fields loosely, so entries
+ * are evaluated at their first lookup. */
+template<class real>
+class BoltzmannTable {
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+public:
+    BoltzmannTable();
+    ~BoltzmannTable();
+
+    /* returns false, and disables the table, if fields are not integral in units of
+     * 1 / scale for scale up to maxScale, or maxK exceeds maxMaxK. */
+    bool set(const EigenRowVector &h, const EigenMatrix &J);
+
+    bool isSet() const {
+        return maxK_ != 0;
+    }
+
+    /* resets the table for (G, kT) if clearing it costs less than nProposals exp() calls.
+     * Returns true if the table is used. */
+    bool build(real twoDivM, real coef, real kT, int nProposals);
+
+    /* evaluates all entries, thus threshold() only reads the table, as required for
+     * lookups from threads.  Returns false if it costs more than nProposals exp() calls. */
+    bool buildAll(real twoDivM, real coef, real kT, int nProposals);
+
+    /* qField = q(y, x) * field(x), nbSum = q(y, x) * (q(y - 1, x) + q(y + 1, x)). */
+    real threshold(real qField, int nbSum) {
+        /* qField * scale is integral, rounded to cancel errors of products. */
+        real v = qField * scale_;
+        int k = int(v + ((v < real(0.)) ? real(-0.5) : real(0.5)));
+        real &entry = table_[(nbSum / 2 + 1) * width_ + k + maxK_];
+        if (entry < real(0.))
+            entry = evaluate(k, nbSum);
+        return entry;
+    }
+
+private:
+    enum {
+        maxScale = 1024,
+        maxMaxK = 1 << 16,
+        /* clearing an entry costs far less than exp(). */
+        clearsPerExp = 16,
+    };
+
+    real evaluate(int k, int nbSum) const;
+
+    BoltzmannTable(const BoltzmannTable &);
+    BoltzmannTable &operator=(const BoltzmannTable &);
+
+    real scale_;
+    int maxK_, width_;
+    real *table_;
+    real twoDivM_, coef_, kT_;
+};
+
+}
+
+#endif
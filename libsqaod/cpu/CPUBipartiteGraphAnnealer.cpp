@@ -3,7 +3,9 @@
 #include <float.h>
 #include <algorithm>
 #include <exception>
+#include <time.h>
 #include "CPUFormulas.h"
+#include "Metropolis.h"
 
 
 using namespace sqaod;
@@ -12,19 +14,45 @@ template<class real>
 CPUBipartiteGraphAnnealer<real>::CPUBipartiteGraphAnnealer() {
     m_ = -1;
     annState_ = annNone;
+    algo_ = algoNaive;
+    sweepOrder_ = sweepRandom;
+    seed_ = 0;
+    qPacked_ = false;
+    localFieldsValid_ = false;
+    nFlips_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
 }
 
 template<class real>
 CPUBipartiteGraphAnnealer<real>::~CPUBipartiteGraphAnnealer() {
+    delete [] randomPool_;
 }
 
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::seed(unsigned long seed) {
     random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
     annState_ |= annRandSeedGiven;
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::setRandomBackend(RandomBackend backend) {
+    random_.setBackend(backend);
+    random_.seed(seed_);
+    seedRandomPool();
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        randomPool_[idx].setBackend(random_.getBackend());
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+    }
+}
+
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::getProblemSize(SizeType *N0, SizeType *N1, SizeType *m) const {
     *N0 = N0_;
@@ -51,6 +79,14 @@ void CPUBipartiteGraphAnnealer<real>::setProblem(const Vector &b0, const Vector
         J_ *= real(-1.);
         c_ *= real(-1.);
     }
+    EigenMatrix J4 = real(4.) * J_, J4t = J4.transpose();
+    packedJ_.set(J4);
+    packedJt_.set(J4t);
+    qPacked_ = false;
+    Jt_ = J_.transpose();
+    localFieldsValid_ = false;
+    boltzmann0_.set(h0_, Jt_);
+    boltzmann1_.set(h1_, J_);
 }
 
 template<class real>
@@ -60,9 +96,66 @@ void CPUBipartiteGraphAnnealer<real>::setNumTrotters(SizeType nTrotters) {
     matQ0_.resize(m_, N0_);
     matQ1_.resize(m_, N1_);
     E_.resize(m_);
+    qPacked_ = false;
+    localFieldsValid_ = false;
     annState_ |= annNTrottersGiven;
 }
 
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::selectAlgorithm(Algorithm algo) {
+    switch (algo) {
+    case algoColoring:
+    case algoBitPacked:
+        algo_ = algo;
+        break;
+    default:
+        algo_ = algoNaive;
+        break;
+    }
+}
+
+template<class real>
+Algorithm CPUBipartiteGraphAnnealer<real>::getAlgorithm() const {
+    if ((algo_ == algoBitPacked) && !packedJ_.isSet())
+        return algoNaive;
+    return algo_;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::setSweepOrder(SweepOrder order) {
+    switch (order) {
+    case sweepSequential:
+    case sweepPermutation:
+    case sweepBlocked:
+        sweepOrder_ = order;
+        break;
+    default:
+        sweepOrder_ = sweepRandom;
+        break;
+    }
+}
+
+template<class real>
+SweepOrder CPUBipartiteGraphAnnealer<real>::getSweepOrder() const {
+    return sweepOrder_;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int CPUBipartiteGraphAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
 template<class real>
 const BitsPairArray &CPUBipartiteGraphAnnealer<real>::get_x() const {
     return bitsPairX_;
@@ -71,9 +164,12 @@ const BitsPairArray &CPUBipartiteGraphAnnealer<real>::get_x() const {
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::set_x(const Bits &x0, const Bits &x1) {
     EigenRowVector ex0 = x0.mapToRowVector().cast<real>();
-    EigenRowVector ex1 = x0.mapToRowVector().cast<real>();
+    EigenRowVector ex1 = x1.mapToRowVector().cast<real>();
     matQ0_.rowwise() = (ex0.array() * 2 - 1).matrix();
     matQ1_.rowwise() = (ex1.array() * 2 - 1).matrix();
+    qPacked_ = false;
+    localFieldsValid_ = false;
+    monitor_.reset();
     annState_ |= annQSet;
 }
 
@@ -107,11 +203,15 @@ void CPUBipartiteGraphAnnealer<real>::randomize_q() {
     q = matQ1_.data();
     for (int idx = 0; idx < IdxType(N1_ * m_); ++idx)
         q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    qPacked_ = false;
+    localFieldsValid_ = false;
+    monitor_.reset();
     annState_ |= annQSet;
 }
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::calculate_E() {
+    unpackSpins();
     BGFuncs<real>::calculate_E(&E_, h0_, h1_, J_, c_, matQ0_, matQ1_);
     if (om_ == optMaximize)
         E_.mapToRowVector() *= real(-1.);
@@ -120,7 +220,7 @@ void CPUBipartiteGraphAnnealer<real>::calculate_E() {
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::initAnneal() {
     if (!(annState_ & annRandSeedGiven))
-        random_.seed();
+        seed((unsigned long)time(NULL));
     annState_ |= annRandSeedGiven;
     if (!(annState_ & annNTrottersGiven))
         setNumTrotters((N0_ + N1_) / 4);
@@ -139,37 +239,325 @@ void CPUBipartiteGraphAnnealer<real>::finAnneal() {
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::annealOneStep(real G, real kT) {
-    annealHalfStep(N1_, matQ1_, h1_, J_, matQ0_, G, kT);
-    annealHalfStep(N0_, matQ0_, h0_, J_.transpose(), matQ1_, G, kT);
+    nFlips_ = 0;
+    if (getAlgorithm() == algoBitPacked) {
+        packSpins();
+        annealHalfStepBitPacked(N1_, packedQ1_, h1_, packedJ_, packedQ0_, boltzmann1_, G, kT);
+        annealHalfStepBitPacked(N0_, packedQ0_, h0_, packedJt_, packedQ1_, boltzmann0_, G, kT);
+    }
+    else {
+        unpackSpins();
+        if (!localFieldsValid_)
+            syncLocalFields();
+        if (algo_ == algoColoring) {
+            annealHalfStepColoring(N1_, matQ1_, h1_, matH1_, &matH0_, J_, G, kT);
+            annealHalfStepColoring(N0_, matQ0_, h0_, matH0_, &matH1_, Jt_, G, kT);
+        }
+        else {
+            annealHalfStep(N1_, matQ1_, h1_, matH1_, boltzmann1_, G, kT);
+            nFlips_ += flipped_.size();
+            updateLocalFields(&matH0_, matQ1_, J_);
+            annealHalfStep(N0_, matQ0_, h0_, matH0_, boltzmann0_, G, kT);
+            nFlips_ += flipped_.size();
+            updateLocalFields(&matH1_, matQ0_, Jt_);
+        }
+    }
+    unsigned long long nTrials = (unsigned long long)(N0_ + N1_) * m_;
+    if (monitor_.tracksEnergy())
+        monitor_.update(nFlips_, nTrials, calculateEmin());
+    else
+        monitor_.update(nFlips_, nTrials);
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::anneal(real *E, Bits *x0, Bits *x1,
+                                             real Ginit, real Gfin, real kT, real tau,
+                                             SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    real Ebest = FLT_MAX;
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        for (real G = Ginit; (Gfin < G) && !monitor_.isFrozen(); G *= tau)
+            annealOneStep(G, kT);
+        finAnneal();
+        for (int idx = 0; idx < IdxType(m_); ++idx) {
+            if (sign * E_(idx) < Ebest) {
+                Ebest = sign * E_(idx);
+                *x0 = bitsPairX_[idx].first;
+                *x1 = bitsPairX_[idx].second;
+            }
+        }
+    }
+    *E = sign * Ebest;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::setStoppingPolicy(const StoppingPolicy &policy) {
+    THROW_IF(policy.maxAcceptanceRate < 0., "maxAcceptanceRate must not be negative.");
+    monitor_.setPolicy(policy);
+}
+
+template<class real>
+const StoppingPolicy &CPUBipartiteGraphAnnealer<real>::getStoppingPolicy() const {
+    return monitor_.getPolicy();
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::getAnnealStatistics(AnnealStatistics *stats) const {
+    *stats = monitor_.getStatistics();
+    if (om_ == optMaximize)
+        stats->Ebest = - stats->Ebest;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::getAcceptanceRates(Vector *rates) const {
+    const std::vector<double> &history = monitor_.getAcceptanceRates();
+    rates->resize(SizeType(history.size()));
+    for (int idx = 0; idx < IdxType(history.size()); ++idx)
+        (*rates)(idx) = real(history[idx]);
+}
+
+template<class real>
+real CPUBipartiteGraphAnnealer<real>::calculateEmin() {
+    unpackSpins();
+    if (!localFieldsValid_)
+        syncLocalFields();
+    /* matH0_ = q1 * J, thus E = c + h0 * q0 + h1 * q1 + q0 * matH0_^T per trotter. */
+    EigenColumnVectorType<real> E = (matH0_.rowwise() + h0_).cwiseProduct(matQ0_).rowwise().sum();
+    E += matQ1_ * h1_.transpose();
+    return c_ + E.minCoeff();
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::syncLocalFields() {
+    matH0_ = matQ1_ * J_;
+    matH1_ = matQ0_ * Jt_;
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::
+updateLocalFields(EigenMatrix *matH, const EigenMatrix &qFlipped, const EigenMatrix &J) {
+    /* a rank-1 update per flip reads a row of J, and a GEMM reads J once per
+     * trotter.  Updates are used while less than 1 / 8 of spins flipped. */
+    int N = IdxType(qFlipped.cols());
+    if (IdxType(N * m_) < IdxType(flipped_.size()) * 8) {
+        *matH = qFlipped * J;
+        return;
+    }
+    for (size_t idx = 0; idx < flipped_.size(); ++idx) {
+        int im = flipped_[idx].first / N;
+        int iq = flipped_[idx].first % N;
+        /* q flipped from -q, thus fields change by 2 * q * J(iq, :). */
+        matH->row(im) += (real(2.) * flipped_[idx].second) * J.row(iq);
+    }
 }
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::
 annealHalfStep(int N, EigenMatrix &qAnneal,
-               const EigenRowVector &h, const EigenMatrix &J,
-               const EigenMatrix &qFixed, real G, real kT) {
-    EigenMatrix dEmat = J * qFixed.transpose();
+               const EigenRowVector &h, const EigenMatrix &matH,
+               BoltzmannTable<real> &boltzmann, real G, real kT) {
     real twoDivM = real(2.) / m_;
     real tempCoef = std::log(std::tanh(G / kT / m_)) / kT;
-    real invKT = real(1.) / kT;
+    bool useTable = boltzmann.build(twoDivM, tempCoef, kT, N * m_);
 
+    flipped_.clear();
+    if ((sweepOrder_ == sweepSequential) && !useTable) {
+        /* spins of one layer in one trotter do not interact, so a row-major sweep
+         * accepts a trotter row in blocks of 64 flips. */
+        real invKT = real(1.) / kT;
+        real dEdivKT[64];
+        for (int im = 0; im < IdxType(m_); ++im) {
+            real *q = &qAnneal(im, 0);
+            const real *q0 = &qAnneal((im + m_ - 1) % m_, 0), *q1 = &qAnneal((im + 1) % m_, 0);
+            const real *field = &matH(im, 0);
+            for (int begin = 0; begin < N; begin += 64) {
+                int n = std::min(64, N - begin);
+                for (int idx = 0; idx < n; ++idx) {
+                    int iq = begin + idx;
+                    real qField = q[iq] * (h[iq] + field[iq]);
+                    real nbSum = q[iq] * (q0[iq] + q1[iq]);
+                    dEdivKT[idx] = (- twoDivM * qField - nbSum * tempCoef) * invKT;
+                }
+                PackedBits accepted = metropolisAccept(dEdivKT, random_, n);
+                for (; accepted != 0; accepted &= accepted - 1) {
+                    int iq = begin + __builtin_ctzll(accepted);
+                    q[iq] = - q[iq];
+                    flipped_.push_back(std::make_pair(im * N + iq, q[iq]));
+                }
+            }
+        }
+        return;
+    }
+    /* matH(:, iq) is read for each iq. */
+    sweepRandom_.draw(random_, N, m_, sweepOrder_, m_);
     for (int loop = 0; loop < IdxType(N * m_); ++loop) {
-        int iq = random_.randInt(N);
-        int im = random_.randInt(m_);
+        int iq = sweepRandom_.x(loop);
+        int im = sweepRandom_.y(loop);
         real q = qAnneal(im, iq);
-        real dE = - twoDivM * q * (h[iq] + dEmat(iq, im));
+        real qField = q * (h[iq] + matH(im, iq));
         int mNeibour0 = (im + m_ - 1) % m_;
         int mNeibour1 = (im + 1) % m_;
-        dE -= q * (qAnneal(mNeibour0, iq) + qAnneal(mNeibour1, iq)) * tempCoef;
-        real thresh = dE < real(0.) ? real(1.) : std::exp(- dE * invKT);
-        if (thresh > random_.random<real>())
+        real nbSum = q * (qAnneal(mNeibour0, iq) + qAnneal(mNeibour1, iq));
+        real thresh;
+        if (useTable) {
+            thresh = boltzmann.threshold(qField, int(nbSum));
+        } else {
+            real dE = - twoDivM * qField - nbSum * tempCoef;
+            thresh = dE < real(0.) ? real(1.) : std::exp(- dE / kT);
+        }
+        if (thresh > sweepRandom_.uniform(loop)) {
             qAnneal(im, iq) = -q;
+            flipped_.push_back(std::make_pair(im * N + iq, -q));
+        }
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::
+annealHalfStepColoring(int N, EigenMatrix &qAnneal,
+                       const EigenRowVector &h, const EigenMatrix &matH,
+                       EigenMatrix *matHOther, const EigenMatrix &J, real G, real kT) {
+    real twoDivM = real(2.) / m_;
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+
+    /* Trotters only interact with their neighbours (y +/- 1), so trotters of the same
+     * color are independent.  With odd m, the last trotter neighbours trotter 0, and
+     * is annealed in its own phase. */
+    int nEvenTrotters = (m_ % 2 == 0) ? IdxType(m_) : std::max(IdxType(m_) - 1, 1);
+    int phaseEnd[] = { nEvenTrotters, nEvenTrotters, IdxType(m_) };
+    int phaseBegin[] = { 0, 1, nEvenTrotters };
+    int phaseStride[] = { 2, 2, 1 };
+
+    for (int phase = 0; phase < 3; ++phase) {
+        if (phaseEnd[phase] <= phaseBegin[phase])
+            continue;
+        int nTrotters = (phaseEnd[phase] - phaseBegin[phase] + phaseStride[phase] - 1) / phaseStride[phase];
+        unsigned long long nFlips = 0;
+#pragma omp parallel num_threads(nThreads_)
+        {
+            Random &random = randomPool_[getThreadNum()];
+#pragma omp for schedule(static) reduction(+:nFlips)
+            for (int idx = 0; idx < nTrotters; ++idx) {
+                int y = phaseBegin[phase] + idx * phaseStride[phase];
+                nFlips += annealTrotterColoring(y, N, qAnneal, h, matH, matHOther, J,
+                                                twoDivM, coef, kT, random);
+            }
+        }
+        nFlips_ += nFlips;
     }
-}                    
+}
+
+template<class real>
+int CPUBipartiteGraphAnnealer<real>::
+annealTrotterColoring(int y, int N, EigenMatrix &qAnneal,
+                      const EigenRowVector &h, const EigenMatrix &matH,
+                      EigenMatrix *matHOther, const EigenMatrix &J,
+                      real twoDivM, real coef, real kT, Random &random) {
+    int neibour0 = (m_ + y - 1) % m_;
+    int neibour1 = (y + 1) % m_;
+    real *q = &qAnneal(y, 0);
+    const real *q0 = &qAnneal(neibour0, 0), *q1 = &qAnneal(neibour1, 0);
+    const real *field = &matH(y, 0);
+    real invKT = real(1.) / kT;
+    /* fields of the other layer are updated by rows of J up to maxUpdates flips,
+     * and recalculated by a GEMV beyond. */
+    int maxUpdates = N / 8;
+    int nFlipped = 0;
+
+    real dEdivKT[64];
+    for (int begin = 0; begin < N; begin += 64) {
+        int n = std::min(64, N - begin);
+        for (int idx = 0; idx < n; ++idx) {
+            int iq = begin + idx;
+            real qField = q[iq] * (h(iq) + field[iq]);
+            real nbSum = q[iq] * (q0[iq] + q1[iq]);
+            dEdivKT[idx] = (- twoDivM * qField - nbSum * coef) * invKT;
+        }
+        PackedBits accepted = metropolisAccept(dEdivKT, random, n);
+        for (; accepted != 0; accepted &= accepted - 1) {
+            int iq = begin + __builtin_ctzll(accepted);
+            q[iq] = - q[iq];
+            if (nFlipped < maxUpdates)
+                matHOther->row(y) += (real(2.) * q[iq]) * J.row(iq);
+            ++nFlipped;
+        }
+    }
+    if (maxUpdates <= nFlipped)
+        matHOther->row(y).noalias() = qAnneal.row(y) * J;
+    return nFlipped;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::
+annealHalfStepBitPacked(int N, PackedSpinMatrix &qAnneal,
+                        const EigenRowVector &h, const BitPlaneCouplings &J,
+                        const PackedSpinMatrix &qFixed, BoltzmannTable<real> &boltzmann,
+                        real G, real kT) {
+    EigenMatrix dEmat(N, m_);
+    for (int iq = 0; iq < N; ++iq) {
+        for (int im = 0; im < IdxType(m_); ++im)
+            dEmat(iq, im) = real(0.25) * real(J.dot(iq, qFixed.row(im)));
+    }
+    real twoDivM = real(2.) / m_;
+    real tempCoef = std::log(std::tanh(G / kT / m_)) / kT;
+    bool useTable = boltzmann.build(twoDivM, tempCoef, kT, N * m_);
+
+    /* dEmat(iq, :) is read for each iq. */
+    sweepRandom_.draw(random_, N, m_, sweepOrder_, m_);
+    for (int loop = 0; loop < IdxType(N * m_); ++loop) {
+        int iq = sweepRandom_.x(loop);
+        int im = sweepRandom_.y(loop);
+        real q = qAnneal.get(im, iq) ? real(1.) : real(-1.);
+        real qField = q * (h[iq] + dEmat(iq, im));
+        int mNeibour0 = (im + m_ - 1) % m_;
+        int mNeibour1 = (im + 1) % m_;
+        /* q * (q(mNeibour0, iq) + q(mNeibour1, iq)) = 2 - 2 * (number of disagreements) */
+        int nDisagreements = qAnneal.countDisagreements(im, mNeibour0, mNeibour1, iq);
+        int nbSum = 2 - 2 * nDisagreements;
+        real thresh;
+        if (useTable) {
+            thresh = boltzmann.threshold(qField, nbSum);
+        } else {
+            real dE = - twoDivM * qField - real(nbSum) * tempCoef;
+            thresh = dE < real(0.) ? real(1.) : std::exp(- dE / kT);
+        }
+        if (thresh > sweepRandom_.uniform(loop)) {
+            qAnneal.flip(im, iq);
+            ++nFlips_;
+        }
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::packSpins() {
+    if (qPacked_)
+        return;
+    packedQ0_.pack(matQ0_);
+    packedQ1_.pack(matQ1_);
+    qPacked_ = true;
+}
+
+template<class real>
+void CPUBipartiteGraphAnnealer<real>::unpackSpins() {
+    if (!qPacked_)
+        return;
+    packedQ0_.unpack(&matQ0_);
+    packedQ1_.unpack(&matQ1_);
+    qPacked_ = false;
+    localFieldsValid_ = false;
+}
         
 
 template<class real>
 void CPUBipartiteGraphAnnealer<real>::syncBits() {
+    unpackSpins();
     bitsPairX_.clear();
     bitsPairQ_.clear();
     Bits x0, x1;
@@ -2,8 +2,12 @@
 #ifndef CPU_BIPARTITEGRAPH_ANNEALER_H__
 #define CPU_BIPARTITEGRAPH_ANNEALER_H__
 
+#include <vector>
 #include <common/Common.h>
 #include <cpu/Random.h>
+#include <cpu/PackedSpins.h>
+#include <cpu/BoltzmannTable.h>
+#include <cpu/AnnealMonitor.h>
 
 
 namespace sqaod {
@@ -27,6 +31,30 @@ public:
 
     void setNumTrotters(SizeType nTrotters);
 
+    /* rngMT19937 (default), rngXoshiro256 or rngPhilox.  Random numbers are
+     * reseeded with the last seed given. */
+    void setRandomBackend(RandomBackend backend);
+
+    /* algoNaive (default), algoColoring or algoBitPacked.  algoBitPacked requires
+     * integral 4J, that is, integral W.  Otherwise algoNaive is used, and getAlgorithm()
+     * returns it.  algoColoring anneals trotters of the same color in parallel. */
+    void selectAlgorithm(Algorithm algo);
+
+    Algorithm getAlgorithm() const;
+
+    /* sweepRandom (default), sweepSequential, sweepPermutation or sweepBlocked.
+     * algoColoring updates all spins of a trotter at once, and ignores the order.
+     * sweepSequential accepts the spins of a trotter in blocks without the Boltzmann table. */
+    void setSweepOrder(SweepOrder order);
+
+    SweepOrder getSweepOrder() const;
+
+    /* threads for algoColoring.  Each thread owns a random number stream, thus
+     * results are reproducible for the same seed and number of threads. */
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
     const Vector &get_E() const;
 
     const BitsPairArray &get_x() const;
@@ -48,25 +76,92 @@ public:
     void finAnneal();
 
     void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules, G = Ginit * tau^n while Gfin < G,
+     * and returns the best E and (x0, x1) found across repeats.  A schedule ends
+     * early once annealing is frozen under the stopping policy. */
+    void anneal(real *E, Bits *x0, Bits *x1,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+    /* steps are tracked from randomize_q() or set_x(). */
+    void setStoppingPolicy(const StoppingPolicy &policy);
+
+    const StoppingPolicy &getStoppingPolicy() const;
+
+    /* Ebest is given in the direction of optimization. */
+    void getAnnealStatistics(AnnealStatistics *stats) const;
+
+    /* acceptance rates of steps tracked. */
+    void getAcceptanceRates(Vector *rates) const;
     
 private:
     void syncBits();
+    void seedRandomPool();
 
+    /* local fields from the other layer, matH0_ = q1 * J, matH1_ = q0 * J^T, are kept
+     * across half steps, and updated by rows of J for spins flipped. */
+    void syncLocalFields();
     void annealHalfStep(int N, EigenMatrix &qAnneal,
-                        const EigenRowVector &h, const EigenMatrix &J,
-                        const EigenMatrix &qFixed, real G, real kT);
+                        const EigenRowVector &h, const EigenMatrix &matH,
+                        BoltzmannTable<real> &boltzmann, real G, real kT);
+    /* J is indexed by spins of qFlipped, (N, N') for matH of (m, N'). */
+    void updateLocalFields(EigenMatrix *matH, const EigenMatrix &qFlipped, const EigenMatrix &J);
+
+    /* spins of a half step are independent except for neighbouring trotters, thus
+     * trotters of the same color are annealed by threads, and spins of a trotter
+     * are accepted by vectorized Metropolis tests.  The thread annealing trotter y
+     * updates matHOther(y, :). */
+    void annealHalfStepColoring(int N, EigenMatrix &qAnneal,
+                                const EigenRowVector &h, const EigenMatrix &matH,
+                                EigenMatrix *matHOther, const EigenMatrix &J, real G, real kT);
+    /* returns the number of flips. */
+    int annealTrotterColoring(int y, int N, EigenMatrix &qAnneal,
+                               const EigenRowVector &h, const EigenMatrix &matH,
+                               EigenMatrix *matHOther, const EigenMatrix &J,
+                               real twoDivM, real coef, real kT, Random &random);
+
+    /* spins are packed to bits, and fields are calculated by popcounts over
+     * bit-planes of 4J.  matQ0_ and matQ1_ are synchronized lazily. */
+    void annealHalfStepBitPacked(int N, PackedSpinMatrix &qAnneal,
+                                 const EigenRowVector &h, const BitPlaneCouplings &J,
+                                 const PackedSpinMatrix &qFixed, BoltzmannTable<real> &boltzmann,
+                                 real G, real kT);
+    void packSpins();
+    void unpackSpins();
+
+    /* the lowest energy among trotters from local fields, in the minimizing direction. */
+    real calculateEmin();
+
     int annState_;
+    Algorithm algo_;
+    SweepOrder sweepOrder_;
 
     Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SweepRandom<real> sweepRandom_;
     SizeType N0_, N1_, m_;
     EigenRowVector h0_, h1_;
-    EigenMatrix J_;
+    EigenMatrix J_, Jt_;
     real c_;
     OptimizeMethod om_;
     Vector E_;
     EigenMatrix matQ0_, matQ1_;
+    EigenMatrix matH0_, matH1_;
+    bool localFieldsValid_;
+    /* spins flipped in the last half step, (im * N + iq, q after the flip). */
+    std::vector<std::pair<IdxType, real> > flipped_;
     BitsPairArray bitsPairX_;
     BitsPairArray bitsPairQ_;
+    PackedSpinMatrix packedQ0_, packedQ1_;
+    BitPlaneCouplings packedJ_, packedJt_;
+    bool qPacked_;
+    /* replace exp() if fields of each layer are integral, as for integral W and b. */
+    BoltzmannTable<real> boltzmann0_, boltzmann1_;
+    /* flips accepted in the current step */
+    unsigned long long nFlips_;
+    AnnealMonitor monitor_;
 };
 
 }
@@ -11,10 +11,16 @@ template<class real>
 CPUBipartiteGraphBFSolver<real>::CPUBipartiteGraphBFSolver() {
     tileSize0_ = 1024;
     tileSize1_ = 1024;
+    topK_ = 1;
+    maxNumMinStates_ = 1 << 16;
+    nMinStates_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    searchers_ = new BatchSearcher[nThreads_];
 }
 
 template<class real>
 CPUBipartiteGraphBFSolver<real>::~CPUBipartiteGraphBFSolver() {
+    delete [] searchers_;
 }
 
 
@@ -34,15 +40,91 @@ void CPUBipartiteGraphBFSolver<real>::setProblem(const Vector &b0, const Vector
                                                  const Matrix &W, OptimizeMethod om) {
     N0_ = b0.size;
     N1_ = b1.size;
-    b0_ = b0.mapToRowVector();
-    b1_ = b1.mapToRowVector();
-    W_ = W.map();
+    b0full_ = b0.mapToRowVector();
+    b1full_ = b1.mapToRowVector();
+    Wfull_ = W.map();
     om_ = om;
     if (om_ == optMaximize) {
-        W_ *= real(-1.);
-        b0_ *= real(-1.);
-        b1_ *= real(-1.);
+        Wfull_ *= real(-1.);
+        b0full_ *= real(-1.);
+        b1full_ *= real(-1.);
     }
+    clearClampedBits();
+}
+
+namespace {
+
+void splitClampedBits(std::vector<IdxType> *freePos, std::vector<IdxType> *onPos,
+                      const Bits &mask, const Bits &x) {
+    for (IdxType pos = 0; pos < (IdxType)mask.size; ++pos) {
+        if (mask(pos) == 0)
+            freePos->push_back(pos);
+        else if (x(pos) != 0)
+            onPos->push_back(pos);
+    }
+}
+
+}
+
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::setClampedBits(const Bits &mask0, const Bits &x0,
+                                                     const Bits &mask1, const Bits &x1) {
+    THROW_IF((mask0.size != N0_) || (x0.size != N0_), "Dimension of mask0 or x0 does not match N0.");
+    THROW_IF((mask1.size != N1_) || (x1.size != N1_), "Dimension of mask1 or x1 does not match N1.");
+    std::vector<IdxType> freePos0, onPos0, freePos1, onPos1;
+    splitClampedBits(&freePos0, &onPos0, mask0, x0);
+    splitClampedBits(&freePos1, &onPos1, mask1, x1);
+    THROW_IF((63 < freePos0.size()) || (63 < freePos1.size()),
+             "# of free bits must be less than 64.");
+    subSpace0_.set(x0, freePos0);
+    subSpace1_.set(x1, freePos1);
+
+    /* E = b0 x0 + b1 x1 + x1^T W x0, in which fixed bits of x1 (x0) add W(j, :) (W(:, i))
+     * to b0 (b1) of free bits. */
+    int nFree0 = (int)freePos0.size(), nFree1 = (int)freePos1.size();
+    b0_.resize(nFree0);
+    for (int i = 0; i < nFree0; ++i) {
+        b0_(i) = b0full_(freePos0[i]);
+        for (size_t jOn = 0; jOn < onPos1.size(); ++jOn)
+            b0_(i) += Wfull_(onPos1[jOn], freePos0[i]);
+    }
+    b1_.resize(nFree1);
+    for (int j = 0; j < nFree1; ++j) {
+        b1_(j) = b1full_(freePos1[j]);
+        for (size_t iOn = 0; iOn < onPos0.size(); ++iOn)
+            b1_(j) += Wfull_(freePos1[j], onPos0[iOn]);
+    }
+    W_.resize(nFree1, nFree0);
+    for (int j = 0; j < nFree1; ++j) {
+        for (int i = 0; i < nFree0; ++i)
+            W_(j, i) = Wfull_(freePos1[j], freePos0[i]);
+    }
+    Ec_ = real(0.);
+    for (size_t iOn = 0; iOn < onPos0.size(); ++iOn)
+        Ec_ += b0full_(onPos0[iOn]);
+    for (size_t jOn = 0; jOn < onPos1.size(); ++jOn) {
+        Ec_ += b1full_(onPos1[jOn]);
+        for (size_t iOn = 0; iOn < onPos0.size(); ++iOn)
+            Ec_ += Wfull_(onPos1[jOn], onPos0[iOn]);
+    }
+    setUpSearchers();
+}
+
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::clearClampedBits() {
+    subSpace0_.setFullSpace(N0_);
+    subSpace1_.setFullSpace(N1_);
+    b0_ = b0full_;
+    b1_ = b1full_;
+    W_ = Wfull_;
+    Ec_ = real(0.);
+    setUpSearchers();
+}
+
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::setUpSearchers() {
+    for (int idx = 0; idx < nThreads_; ++idx)
+        searchers_[idx].setProblem(b0_, b1_, W_);
 }
 
 template<class real>
@@ -51,6 +133,49 @@ void CPUBipartiteGraphBFSolver<real>::setTileSize(SizeType tileSize0, SizeType t
     tileSize1_ = tileSize1;
 }
 
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::setTopK(SizeType K) {
+    THROW_IF(K == 0, "K must be a positive integer.");
+    topK_ = K;
+}
+
+template<class real>
+SizeType CPUBipartiteGraphBFSolver<real>::getTopK() const {
+    return topK_;
+}
+
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::setMaxNumMinStates(SizeType maxNumMinStates) {
+    maxNumMinStates_ = maxNumMinStates;
+}
+
+template<class real>
+unsigned long long CPUBipartiteGraphBFSolver<real>::getNumMinStates() const {
+    return nMinStates_;
+}
+
+template<class real>
+real CPUBipartiteGraphBFSolver<real>::getMinE() const {
+    real E = minE_ + Ec_;
+    return (om_ == optMaximize) ? - E : E;
+}
+
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] searchers_;
+    nThreads_ = nThreads;
+    searchers_ = new BatchSearcher[nThreads_];
+    setUpSearchers();
+}
+
+template<class real>
+int CPUBipartiteGraphBFSolver<real>::getNumThreads() const {
+    return nThreads_;
+}
+
 template<class real>
 const BitsPairArray &CPUBipartiteGraphBFSolver<real>::get_x() const {
     return xPairs_;
@@ -64,26 +189,77 @@ const VectorType<real> &CPUBipartiteGraphBFSolver<real>::get_E() const {
 template<class real>
 void CPUBipartiteGraphBFSolver<real>::initSearch() {
     minE_ = FLT_MAX;
+    nMinStates_ = 0;
     xPackedPairs_.clear();
-    x0max_ = 1ull << N0_;
-    x1max_ = 1ull << N1_;
+    x0max_ = subSpace0_.getNumStates();
+    x1max_ = subSpace1_.getNumStates();
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        searchers_[idx].setTopK(topK_);
+        searchers_[idx].setMaxNumMinStates(maxNumMinStates_);
+        searchers_[idx].initSearch();
+    }
 }
 
 template<class real>
 void CPUBipartiteGraphBFSolver<real>::finSearch() {
+    if (1 < topK_) {
+        finSearchTopK();
+        return;
+    }
+    /* reduction of per-thread results. */
+    for (int idx = 0; idx < nThreads_; ++idx)
+        minE_ = std::min(minE_, searchers_[idx].get_minStates().getEmin());
+    xPackedPairs_.clear();
+    nMinStates_ = 0;
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        const typename BatchSearcher::MinStateList &minStates = searchers_[idx].get_minStates();
+        if (minStates.getEmin() != minE_)
+            continue;
+        nMinStates_ += minStates.getNumStates();
+        for (SizeType iPair = 0; iPair < minStates.size(); ++iPair)
+            xPackedPairs_.pushBack(minStates[iPair]);
+    }
+    std::sort(xPackedPairs_.begin(), xPackedPairs_.end());
+    /* each thread stores its smallest maxNumMinStates_ pairs, thus the smallest of all are kept. */
+    SizeType nStored = std::min((SizeType)xPackedPairs_.size(), maxNumMinStates_);
+
     xPairs_.clear();
-    for (PackedBitsPairArray::const_iterator it = xPackedPairs_.begin();
-         it != xPackedPairs_.end(); ++it) {
+    for (SizeType iPair = 0; iPair < nStored; ++iPair) {
         Bits x0(N0_), x1(N1_);
-        unpackBits(&x0, it->first, N0_);
-        unpackBits(&x1, it->second, N1_);
+        subSpace0_.unpack(&x0, xPackedPairs_[iPair].first);
+        subSpace1_.unpack(&x1, xPackedPairs_[iPair].second);
         xPairs_.pushBack(BitsPairArray::ValueType(x0, x1));
     }
-    real tmpE = (om_ == optMaximize) ? -minE_ : minE_;
-    E_.resize((SizeType)xPackedPairs_.size());
+    real tmpE = (om_ == optMaximize) ? -(minE_ + Ec_) : minE_ + Ec_;
+    E_.resize(nStored);
     E_.mapToRowVector().array() = tmpE;
 }
 
+template<class real>
+void CPUBipartiteGraphBFSolver<real>::finSearchTopK() {
+    typedef typename BatchSearcher::TopK TopK;
+    TopK topK;
+    topK.setCapacity(topK_);
+    for (int idx = 0; idx < nThreads_; ++idx)
+        topK.merge(searchers_[idx].get_topK());
+    std::vector<typename TopK::State> states;
+    topK.getSorted(&states);
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    minE_ = states.empty() ? real(FLT_MAX) : states[0].E;
+    xPackedPairs_.clear();
+    xPairs_.clear();
+    E_.resize((SizeType)states.size());
+    for (int idx = 0; idx < (int)states.size(); ++idx) {
+        xPackedPairs_.pushBack(states[idx].x);
+        Bits x0(N0_), x1(N1_);
+        subSpace0_.unpack(&x0, states[idx].x.first);
+        subSpace1_.unpack(&x1, states[idx].x.second);
+        xPairs_.pushBack(BitsPairArray::ValueType(x0, x1));
+        E_(idx) = sign * (states[idx].E + Ec_);
+    }
+}
+
 template<class real>
 void CPUBipartiteGraphBFSolver<real>::searchRange(PackedBits iBegin0, PackedBits iEnd0,
                                                   PackedBits iBegin1, PackedBits iEnd1) {
@@ -92,19 +268,31 @@ void CPUBipartiteGraphBFSolver<real>::searchRange(PackedBits iBegin0, PackedBits
     iBegin1 = std::min(std::max(0ULL, iBegin1), x1max_);
     iEnd1 = std::min(std::max(0ULL, iEnd1), x1max_);
 
-    BGFuncs<real>::batchSearch(&minE_, &xPackedPairs_, b0_ ,b1_, W_, iBegin0, iEnd0, iBegin1, iEnd1);
-    /* FIXME: add max limits of # min vectors. */
+    searchers_[0].searchRange(iBegin0, iEnd0, iBegin1, iEnd1);
 }
 
 template<class real>
 void CPUBipartiteGraphBFSolver<real>::search() {
+    initSearch();
     PackedBits iStep0 = std::min(tileSize0_, x0max_);
     PackedBits iStep1 = std::min(tileSize1_, x1max_);
+    long long nTiles0 = (long long)((x0max_ + iStep0 - 1) / iStep0);
+    long long nTiles1 = (long long)((x1max_ + iStep1 - 1) / iStep1);
+    long long nTiles = nTiles0 * nTiles1;
 
-    initSearch();
-    for (PackedBits iTile1 = 0; iTile1 < x1max_; iTile1 += iStep1) {
-        for (PackedBits iTile0 = 0; iTile0 < x0max_; iTile0 += iStep0) {
-            searchRange(iTile0, iTile0 + iStep0, iTile1, iTile1 + iStep1);
+    /* 2D tiles are flattened in x0-major order, and consecutive tiles are handed to
+     * a thread as a chunk, so that each thread reuses cached x0 partial products. */
+    long long chunk = std::max(1LL, std::min(nTiles1, nTiles / (nThreads_ * 4)));
+#pragma omp parallel num_threads(nThreads_)
+    {
+        BatchSearcher &searcher = searchers_[getThreadNum()];
+#pragma omp for schedule(dynamic, chunk)
+        for (long long iTile = 0; iTile < nTiles; ++iTile) {
+            PackedBits iBegin0 = PackedBits(iTile / nTiles1) * iStep0;
+            PackedBits iBegin1 = PackedBits(iTile % nTiles1) * iStep1;
+            PackedBits iEnd0 = std::min(iBegin0 + iStep0, x0max_);
+            PackedBits iEnd1 = std::min(iBegin1 + iStep1, x1max_);
+            searcher.searchRange(iBegin0, iEnd0, iBegin1, iEnd1);
         }
     }
     finSearch();
@@ -3,7 +3,9 @@
 #define CPU_BIPARTITEGRAPH_BF_SOLVER_H__
 
 #include <common/Common.h>
+#include <common/BitsSubSpace.h>
 #include <cpu/Random.h>
+#include <cpu/CPUBipartiteGraphBatchSearch.h>
 
 
 namespace sqaod {
@@ -26,8 +28,37 @@ public:
     void setProblem(const Vector &b0, const Vector &b1, const Matrix &W,
                     OptimizeMethod om);
 
+    /* fixes x0(i) for mask0(i) != 0 and x1(j) for mask1(j) != 0, and enumerates other
+     * bits, whose number must be less than 64 in each layer.  Fixed bits are folded into
+     * b0, b1 of free bits and a constant, and get_x() gives whole (x0, x1).
+     * setProblem() clears fixed bits. */
+    void setClampedBits(const Bits &mask0, const Bits &x0, const Bits &mask1, const Bits &x1);
+
+    void clearClampedBits();
+
     void setTileSize(SizeType tileSize0, SizeType tileSize1);
 
+    /* K = 1 (default) gives all (x0, x1) at the minimum E.  K > 1 gives the K lowest
+     * states in ascending order of E, and ties at the K-th E are broken by smaller x0, x1. */
+    void setTopK(SizeType K);
+
+    SizeType getTopK() const;
+
+    /* max # of (x0, x1) stored at the minimum E with K = 1, 65536 by default.  The
+     * smallest pairs are stored.  Buffers are allocated before search, and 0 only counts
+     * minima. */
+    void setMaxNumMinStates(SizeType maxNumMinStates);
+
+    /* # of (x0, x1) at the minimum E found in the last search, including those not stored. */
+    unsigned long long getNumMinStates() const;
+
+    /* minimum E of the last search.  get_E() is empty if no state is stored. */
+    real getMinE() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
     const BitsPairArray &get_x() const;
 
     const Vector &get_E() const;
@@ -42,13 +73,31 @@ public:
     void search();
     
 private:    
+    typedef CPUBipartiteGraphBatchSearch<real> BatchSearcher;
+
+    void setUpSearchers();
+
+    void finSearchTopK();
+
     Random random_;
     SizeType N0_, N1_;
+    /* x0 and x1 are enumerated in sub-spaces, indexed by PackedBits. */
+    BitsSubSpace subSpace0_, subSpace1_;
+    /* b0, b1, W of the whole problem, and those of free bits with the constant of
+     * fixed bits. */
+    EigenRowVector b0full_, b1full_;
+    EigenMatrix Wfull_;
     EigenRowVector b0_, b1_;
     EigenMatrix W_;
+    real Ec_;
     OptimizeMethod om_;
     PackedBits tileSize0_, tileSize1_;
+    SizeType topK_;
+    SizeType maxNumMinStates_;
+    unsigned long long nMinStates_;
     PackedBits x0max_, x1max_;
+    int nThreads_;
+    BatchSearcher *searchers_;
     real minE_;
     Vector E_;
     PackedBitsPairArray xPackedPairs_;
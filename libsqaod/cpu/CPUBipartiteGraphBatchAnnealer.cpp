@@ -0,0 +1,288 @@
+#include "CPUBipartiteGraphBatchAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUBipartiteGraphBatchAnnealer<real>::CPUBipartiteGraphBatchAnnealer() {
+    nProblems_ = 0;
+    N0_ = N1_ = 0;
+    m_ = -1;
+    annState_ = annNone;
+    localFieldsValid_ = false;
+    random_ = NULL;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+}
+
+template<class real>
+CPUBipartiteGraphBatchAnnealer<real>::~CPUBipartiteGraphBatchAnnealer() {
+    delete [] random_;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::seed(unsigned long seed) {
+    seed_ = seed;
+    for (int p = 0; p < IdxType(nProblems_); ++p)
+        random_[p].seed(seed_, Random::streamId(p, 0));
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::getProblemSize(SizeType *nProblems,
+                                                          SizeType *N0, SizeType *N1,
+                                                          SizeType *m) const {
+    *nProblems = nProblems_;
+    *N0 = N0_;
+    *N1 = N1_;
+    *m = m_;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::setProblems(const Matrix &b0s, const Matrix &b1s,
+                                                       const Matrix &Ws, OptimizeMethod om) {
+    THROW_IF((b0s.rows != b1s.rows) || (b0s.cols != Ws.cols) || (Ws.rows != b0s.rows * b1s.cols),
+             "Shapes of b0s, b1s and Ws do not match.");
+    SizeType nProblems = b0s.rows;
+    bool reshaped = (nProblems != nProblems_) || (b0s.cols != N0_) || (b1s.cols != N1_);
+    if (nProblems != nProblems_) {
+        delete [] random_;
+        random_ = new Random[nProblems];
+        nProblems_ = nProblems;
+        if (annState_ & annRandSeedGiven)
+            seed(seed_);
+    }
+    N0_ = b0s.cols;
+    N1_ = b1s.cols;
+    h0_.resize(nProblems_, N0_);
+    h1_.resize(nProblems_, N1_);
+    J_.resize(nProblems_ * N1_, N0_);
+    Jt_.resize(nProblems_ * N0_, N1_);
+    c_.resize(nProblems_);
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        Matrix W, J;
+        W.set(const_cast<real*>(&Ws(p * N1_, 0)), N1_, N0_);
+        J.set(&J_(p * N1_, 0), N1_, N0_);
+        Vector b0, b1, h0, h1;
+        b0.set(const_cast<real*>(&b0s(p, 0)), N0_);
+        b1.set(const_cast<real*>(&b1s(p, 0)), N1_);
+        h0.set(&h0_(p, 0), N0_);
+        h1.set(&h1_(p, 0), N1_);
+        BGFuncs<real>::calculate_hJc(&h0, &h1, &J, &c_(p), b0, b1, W);
+    }
+    om_ = om;
+    if (om_ == optMaximize) {
+        h0_ *= real(-1.);
+        h1_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    for (int p = 0; p < IdxType(nProblems_); ++p)
+        Jt_.middleRows(p * N0_, N0_) = J_.middleRows(p * N1_, N1_).transpose();
+    /* q buffers follow the new shape, and q is randomized again. */
+    if (reshaped) {
+        if (annState_ & annNTrottersGiven)
+            setNumTrotters(m_);
+        annState_ &= ~annQSet;
+    }
+    localFieldsValid_ = false;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::setNumTrotters(SizeType m) {
+    THROW_IF(m <= 0, "nTrotters must be a positive integer.");
+    m_ = m;
+    matQ0_.resize(nProblems_ * m_, N0_);
+    matQ1_.resize(nProblems_ * m_, N1_);
+    matH0_.resize(nProblems_ * m_, N0_);
+    matH1_.resize(nProblems_ * m_, N1_);
+    E_.resize(nProblems_, m_);
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    nThreads_ = nThreads;
+}
+
+template<class real>
+int CPUBipartiteGraphBatchAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const MatrixType<real> &CPUBipartiteGraphBatchAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitMatrix &CPUBipartiteGraphBatchAnnealer<real>::get_x0() const {
+    return bitsX0_;
+}
+
+template<class real>
+const BitMatrix &CPUBipartiteGraphBatchAnnealer<real>::get_x1() const {
+    return bitsX1_;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::randomize_q() {
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        for (int y = 0; y < IdxType(m_); ++y) {
+            real *q = &matQ0_(p * m_ + y, 0);
+            for (int x = 0; x < IdxType(N0_); ++x)
+                q[x] = random_[p].randInt(2) ? real(1.) : real(-1.);
+            q = &matQ1_(p * m_ + y, 0);
+            for (int x = 0; x < IdxType(N1_); ++x)
+                q[x] = random_[p].randInt(2) ? real(1.) : real(-1.);
+        }
+    }
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::calculate_E() {
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        const EigenMatrix q0 = matQ0_.middleRows(p * m_, m_);
+        const EigenMatrix q1 = matQ1_.middleRows(p * m_, m_);
+        EigenMatrix q1J = q1 * J_.middleRows(p * N1_, N1_);
+        E_.map().row(p) = sign * ((q0 * h0_.row(p).transpose()).array()
+                                  + (q1 * h1_.row(p).transpose()).array() + c_(p)
+                                  + q1J.cwiseProduct(q0).rowwise().sum().array()).transpose();
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annNTrottersGiven))
+        setNumTrotters((N0_ + N1_ + 3) / 4);
+    if (!(annState_ & annQSet))
+        randomize_q();
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::annealOneStep(real G, real kT) {
+#pragma omp parallel num_threads(nThreads_)
+    {
+        /* random numbers of a problem are drawn in bulk from its stream. */
+        SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+        for (int p = 0; p < IdxType(nProblems_); ++p) {
+            if (!localFieldsValid_)
+                syncLocalFields(p);
+            annealHalfStep(p, N1_, matQ1_, h1_, matH1_, matH0_, J_, G, kT, sweepRandom);
+            annealHalfStep(p, N0_, matQ0_, h0_, matH0_, matH1_, Jt_, G, kT, sweepRandom);
+        }
+    }
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::anneal(Vector *E, BitMatrix *x0, BitMatrix *x1,
+                                                  real Ginit, real Gfin, real kT, real tau,
+                                                  SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    E->resize(nProblems_);
+    x0->resize(nProblems_, N0_);
+    x1->resize(nProblems_, N1_);
+    EigenRowVector Ebest = EigenRowVector::Constant(nProblems_, FLT_MAX);
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        /* each problem runs the whole schedule while its matrices are in cache. */
+#pragma omp parallel num_threads(nThreads_)
+        {
+            SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+            for (int p = 0; p < IdxType(nProblems_); ++p) {
+                syncLocalFields(p);
+                for (real G = Ginit; Gfin < G; G *= tau) {
+                    annealHalfStep(p, N1_, matQ1_, h1_, matH1_, matH0_, J_, G, kT, sweepRandom);
+                    annealHalfStep(p, N0_, matQ0_, h0_, matH0_, matH1_, Jt_, G, kT, sweepRandom);
+                }
+            }
+        }
+        localFieldsValid_ = true;
+        finAnneal();
+        for (int p = 0; p < IdxType(nProblems_); ++p) {
+            for (int y = 0; y < IdxType(m_); ++y) {
+                if (sign * E_(p, y) < Ebest(p)) {
+                    Ebest(p) = sign * E_(p, y);
+                    x0->map().row(p) = bitsX0_.map().row(p * m_ + y);
+                    x1->map().row(p) = bitsX1_.map().row(p * m_ + y);
+                }
+            }
+        }
+    }
+    E->mapToRowVector() = sign * Ebest;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::syncLocalFields(IdxType p) {
+    matH0_.middleRows(p * m_, m_) = matQ1_.middleRows(p * m_, m_) * J_.middleRows(p * N1_, N1_);
+    matH1_.middleRows(p * m_, m_) = matQ0_.middleRows(p * m_, m_) * Jt_.middleRows(p * N0_, N0_);
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::
+annealHalfStep(IdxType p, int N, EigenMatrix &qAnneal,
+               const EigenMatrix &h, const EigenMatrix &matH,
+               EigenMatrix &matHOther, const EigenMatrix &J, real G, real kT,
+               SweepRandom<real> &sweepRandom) {
+    real twoDivM = real(2.) / m_;
+    real tempCoef = std::log(std::tanh(G / kT / m_)) / kT;
+    int qOffset = p * m_, jOffset = p * N;
+
+    sweepRandom.draw(random_[p], N, m_, sqaod::sweepRandom, m_);
+    for (int loop = 0; loop < IdxType(N * m_); ++loop) {
+        int iq = sweepRandom.x(loop);
+        int im = sweepRandom.y(loop);
+        real q = qAnneal(qOffset + im, iq);
+        real qField = q * (h(p, iq) + matH(qOffset + im, iq));
+        int mNeibour0 = (im + m_ - 1) % m_;
+        int mNeibour1 = (im + 1) % m_;
+        real nbSum = q * (qAnneal(qOffset + mNeibour0, iq) + qAnneal(qOffset + mNeibour1, iq));
+        real dE = - twoDivM * qField - nbSum * tempCoef;
+        real thresh = dE < real(0.) ? real(1.) : std::exp(- dE / kT);
+        if (thresh > sweepRandom.uniform(loop)) {
+            qAnneal(qOffset + im, iq) = -q;
+            /* fields of the other layer are not read in this half step. */
+            matHOther.row(qOffset + im) -= (real(2.) * q) * J.row(jOffset + iq);
+        }
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphBatchAnnealer<real>::syncBits() {
+    bitsX0_.resize(nProblems_ * m_, N0_);
+    bitsX1_.resize(nProblems_ * m_, N1_);
+    bitsX0_.map() = ((matQ0_.array() + real(1.)) / real(2.)).matrix().template cast<char>();
+    bitsX1_.map() = ((matQ1_.array() + real(1.)) / real(2.)).matrix().template cast<char>();
+}
+
+
+template class sqaod::CPUBipartiteGraphBatchAnnealer<float>;
+template class sqaod::CPUBipartiteGraphBatchAnnealer<double>;
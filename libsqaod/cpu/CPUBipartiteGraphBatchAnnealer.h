@@ -0,0 +1,96 @@
+/* -*- c++ -*- */
+#ifndef CPU_BIPARTITEGRAPHBATCHANNEALER_H__
+#define CPU_BIPARTITEGRAPHBATCHANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* Anneals a batch of independent bipartite graph problems of the same (N0, N1),
+ * distributed over threads by problems.  Problems are held in stacked matrices as
+ * CPUDenseGraphBatchAnnealer does, and each problem owns a random number stream. */
+template<class real>
+class CPUBipartiteGraphBatchAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUBipartiteGraphBatchAnnealer();
+    ~CPUBipartiteGraphBatchAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *nProblems, SizeType *N0, SizeType *N1, SizeType *m) const;
+
+    /* b0s is (nProblems, N0), b1s is (nProblems, N1) and Ws is (nProblems * N1, N0). */
+    void setProblems(const Matrix &b0s, const Matrix &b1s, const Matrix &Ws, OptimizeMethod om);
+
+    void setNumTrotters(SizeType m);
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    /* (nProblems, m) */
+    const Matrix &get_E() const;
+
+    /* (nProblems * m, N0) and (nProblems * m, N1) */
+    const BitMatrix &get_x0() const;
+
+    const BitMatrix &get_x1() const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+    /* returns the best E (nProblems), x0 (nProblems, N0) and x1 (nProblems, N1)
+     * of each problem found across nRepeat annealing schedules. */
+    void anneal(Vector *E, BitMatrix *x0, BitMatrix *x1,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+private:
+    void syncBits();
+
+    /* matH0_ = q1 * J, matH1_ = q0 * J^T for each problem. */
+    void syncLocalFields(IdxType p);
+
+    /* J is (N, N') of problems stacked, indexed by spins of qAnneal, and
+     * matHOther is (m, N') of problems stacked. */
+    void annealHalfStep(IdxType p, int N, EigenMatrix &qAnneal,
+                        const EigenMatrix &h, const EigenMatrix &matH,
+                        EigenMatrix &matHOther, const EigenMatrix &J, real G, real kT,
+                        SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    bool localFieldsValid_;
+
+    Random *random_;
+    unsigned long seed_;
+    int nThreads_;
+    SizeType nProblems_, N0_, N1_, m_;
+    OptimizeMethod om_;
+    EigenMatrix h0_, h1_;
+    EigenMatrix J_, Jt_;
+    EigenRowVector c_;
+    EigenMatrix matQ0_, matQ1_;
+    EigenMatrix matH0_, matH1_;
+    Matrix E_;
+    BitMatrix bitsX0_, bitsX1_;
+
+    CPUBipartiteGraphBatchAnnealer(const CPUBipartiteGraphBatchAnnealer &);
+    CPUBipartiteGraphBatchAnnealer &operator=(const CPUBipartiteGraphBatchAnnealer &);
+};
+
+}
+
+#endif
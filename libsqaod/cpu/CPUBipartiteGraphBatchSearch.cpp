@@ -0,0 +1,93 @@
+#include "CPUBipartiteGraphBatchSearch.h"
+
+using namespace sqaod;
+
+template<class real>
+CPUBipartiteGraphBatchSearch<real>::CPUBipartiteGraphBatchSearch() {
+    b0_ = b1_ = nullptr;
+    W_ = nullptr;
+    xBegin0_ = xEnd0_ = 0;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::setProblem(const EigenRowVector &b0, const EigenRowVector &b1,
+                                                    const EigenMatrix &W) {
+    b0_ = &b0;
+    b1_ = &b1;
+    W_ = &W;
+    xBegin0_ = xEnd0_ = 0;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::setTopK(SizeType K) {
+    topK_.setCapacity(K);
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::setMaxNumMinStates(SizeType maxNumMinStates) {
+    minStates_.setCapacity(maxNumMinStates);
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::initSearch() {
+    minStates_.clear();
+    topK_.clear();
+    /* W, b0 may have been updated. */
+    xBegin0_ = xEnd0_ = 0;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::updateX0Products(PackedBits xBegin0, PackedBits xEnd0) {
+    if ((xBegin0 == xBegin0_) && (xEnd0 == xEnd0_))
+        return;
+    int nBatch0 = int(xEnd0 - xBegin0);
+    int N0 = W_->cols();
+    /* resize() does not reallocate if the size stays the same. */
+    bitsSeq0_.resize(nBatch0, N0);
+    createBitsSequence(bitsSeq0_.data(), N0, xBegin0, xEnd0);
+    Wx0_.noalias() = (*W_) * bitsSeq0_.transpose();
+    bx0_.noalias() = (*b0_) * bitsSeq0_.transpose();
+    xBegin0_ = xBegin0;
+    xEnd0_ = xEnd0;
+}
+
+template<class real>
+void CPUBipartiteGraphBatchSearch<real>::searchRange(PackedBits xBegin0, PackedBits xEnd0,
+                                                     PackedBits xBegin1, PackedBits xEnd1) {
+    if ((xEnd0 <= xBegin0) || (xEnd1 <= xBegin1))
+        return;
+    int nBatch0 = int(xEnd0 - xBegin0);
+    int nBatch1 = int(xEnd1 - xBegin1);
+    int N1 = W_->rows();
+
+    updateX0Products(xBegin0, xEnd0);
+
+    bitsSeq1_.resize(nBatch1, N1);
+    createBitsSequence(bitsSeq1_.data(), N1, xBegin1, xEnd1);
+    bx1_.noalias() = (*b1_) * bitsSeq1_.transpose();
+    EBatch_.noalias() = bitsSeq1_ * Wx0_;
+    EBatch_.rowwise() += bx0_;
+    EBatch_.colwise() += bx1_.transpose();
+
+    if (1 < topK_.getCapacity()) {
+        for (int idx1 = 0; idx1 < nBatch1; ++idx1) {
+            for (int idx0 = 0; idx0 < nBatch0; ++idx0) {
+                real Etmp = EBatch_(idx1, idx0);
+                if (Etmp <= topK_.threshold())
+                    topK_.push(Etmp, std::make_pair(xBegin0 + idx0, xBegin1 + idx1));
+            }
+        }
+        return;
+    }
+
+    for (int idx1 = 0; idx1 < nBatch1; ++idx1) {
+        for (int idx0 = 0; idx0 < nBatch0; ++idx0) {
+            real Etmp = EBatch_(idx1, idx0);
+            if (Etmp <= minStates_.getEmin())
+                minStates_.push(Etmp, std::make_pair(xBegin0 + idx0, xBegin1 + idx1));
+        }
+    }
+}
+
+template class sqaod::CPUBipartiteGraphBatchSearch<float>;
+template class sqaod::CPUBipartiteGraphBatchSearch<double>;
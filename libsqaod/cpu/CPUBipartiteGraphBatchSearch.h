@@ -0,0 +1,66 @@
+/* -*- c++ -*- */
+#ifndef CPU_BIPARTITEGRAPH_BATCHSEARCH_H__
+#define CPU_BIPARTITEGRAPH_BATCHSEARCH_H__
+
+#include <common/Common.h>
+#include <cpu/TopKStates.h>
+#include <cpu/MinStates.h>
+
+
+namespace sqaod {
+
+/* Per-thread searcher for bipartite graph brute-force search.
+ * Scratch buffers are reused across tiles, and partial products of x0
+ * (W * x0^T, b0 * x0^T) are cached while the x0 range stays the same. */
+
+template<class real>
+class CPUBipartiteGraphBatchSearch {
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+
+public:
+    typedef TopKStates<real, std::pair<PackedBits, PackedBits> > TopK;
+    typedef MinStates<real, std::pair<PackedBits, PackedBits> > MinStateList;
+
+    CPUBipartiteGraphBatchSearch();
+
+    void setProblem(const EigenRowVector &b0, const EigenRowVector &b1, const EigenMatrix &W);
+
+    /* K = 1 keeps all pairs at the minimum, and K > 1 keeps the K lowest pairs. */
+    void setTopK(SizeType K);
+
+    /* max # of pairs stored at the minimum with K = 1.  0 only counts minima. */
+    void setMaxNumMinStates(SizeType maxNumMinStates);
+
+    void initSearch();
+
+    void searchRange(PackedBits xBegin0, PackedBits xEnd0,
+                     PackedBits xBegin1, PackedBits xEnd1);
+
+    const MinStateList &get_minStates() const {
+        return minStates_;
+    }
+
+    const TopK &get_topK() const {
+        return topK_;
+    }
+
+private:
+    void updateX0Products(PackedBits xBegin0, PackedBits xEnd0);
+
+    const EigenRowVector *b0_, *b1_;
+    const EigenMatrix *W_;
+
+    MinStateList minStates_;
+    TopK topK_;
+
+    PackedBits xBegin0_, xEnd0_;
+    EigenMatrix bitsSeq0_, bitsSeq1_;
+    EigenMatrix Wx0_;
+    EigenRowVector bx0_, bx1_;
+    EigenMatrix EBatch_;
+};
+
+}
+
+#endif
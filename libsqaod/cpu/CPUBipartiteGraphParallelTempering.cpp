@@ -0,0 +1,255 @@
+#include "CPUBipartiteGraphParallelTempering.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <algorithm>
+#include <time.h>
+#include <float.h>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUBipartiteGraphParallelTempering<real>::CPUBipartiteGraphParallelTempering() {
+    N0_ = N1_ = nReplicas_ = 0;
+    annState_ = annNone;
+    fieldsValid_ = false;
+    randomPool_ = NULL;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+}
+
+template<class real>
+CPUBipartiteGraphParallelTempering<real>::~CPUBipartiteGraphParallelTempering() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::seed(unsigned long seed) {
+    seed_ = seed;
+    random_.seed(seed);
+    for (int r = 0; r < IdxType(nReplicas_); ++r)
+        randomPool_[r].seed(seed_, Random::streamId(r + 1, 0));
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::
+getProblemSize(SizeType *N0, SizeType *N1, SizeType *nReplicas) const {
+    *N0 = N0_;
+    *N1 = N1_;
+    *nReplicas = nReplicas_;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::setProblem(const Vector &b0, const Vector &b1,
+                                                          const Matrix &W, OptimizeMethod om) {
+    THROW_IF((W.rows != b1.size) || (W.cols != b0.size), "Shape of W does not match b0 and b1.");
+    N0_ = b0.size;
+    N1_ = b1.size;
+    h0_.resize(N0_);
+    h1_.resize(N1_);
+    J_.resize(N1_, N0_);
+    Vector h0(h0_), h1(h1_);
+    Matrix J(J_);
+    BGFuncs<real>::calculate_hJc(&h0, &h1, &J, &c_, b0, b1, W);
+    om_ = om;
+    if (om_ == optMaximize) {
+        h0_ *= real(-1.);
+        h1_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    Jt_ = J_.transpose();
+    annState_ &= ~annQSet;
+    fieldsValid_ = false;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::setTemperatures(const Vector &kT) {
+    ladder_.setTemperatures(kT);
+    if (kT.size != nReplicas_) {
+        delete [] randomPool_;
+        nReplicas_ = kT.size;
+        randomPool_ = new Random[nReplicas_];
+        if (annState_ & annRandSeedGiven)
+            seed(seed_);
+        annState_ &= ~annQSet;
+    }
+    fieldsValid_ = false;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    nThreads_ = nThreads;
+}
+
+template<class real>
+int CPUBipartiteGraphParallelTempering<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const VectorType<real> &CPUBipartiteGraphParallelTempering<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitsPairArray &CPUBipartiteGraphParallelTempering<real>::get_x() const {
+    return bitsPairX_;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::randomize_q() {
+    matQ0_.resize(nReplicas_, N0_);
+    matQ1_.resize(nReplicas_, N1_);
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        for (int x = 0; x < IdxType(N0_); ++x)
+            matQ0_(r, x) = randomPool_[r].randInt(2) ? real(1.) : real(-1.);
+        for (int y = 0; y < IdxType(N1_); ++y)
+            matQ1_(r, y) = randomPool_[r].randInt(2) ? real(1.) : real(-1.);
+    }
+    Ebest_ = EigenRowVector::Constant(nReplicas_, FLT_MAX);
+    matQ0best_.resize(nReplicas_, N0_);
+    matQ1best_.resize(nReplicas_, N1_);
+    fieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::initAnneal() {
+    THROW_IF(nReplicas_ == 0, "Temperatures not given.");
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annQSet))
+        randomize_q();
+    if (!fieldsValid_)
+        syncFields();
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::finAnneal() {
+    /* energies accumulated by flips are replaced with exact ones. */
+    syncFields();
+    Vector h0(h0_), h1(h1_), Ebest(Ebest_);
+    Matrix J(J_), q0Best(matQ0best_), q1Best(matQ1best_);
+    BGFuncs<real>::calculate_E(&Ebest, h0, h1, J, c_, q0Best, q1Best);
+    syncBits();
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::run(SizeType nExchanges, SizeType nSweeps) {
+    THROW_IF(nSweeps == 0, "nSweeps must be a positive integer.");
+    initAnneal();
+    for (SizeType loop = 0; loop < nExchanges; ++loop) {
+#pragma omp parallel num_threads(nThreads_)
+        {
+            SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+            for (int r = 0; r < IdxType(nReplicas_); ++r)
+                sweepReplica(r, nSweeps, sweepRandom);
+        }
+        ladder_.exchange(Ereplica_.data(), random_);
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::getBest(real *E, Bits *x0, Bits *x1) const {
+    THROW_IF(Ebest_.size() == 0, "Not annealed.");
+    IdxType rBest;
+    Ebest_.minCoeff(&rBest);
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    *E = sign * Ebest_(rBest);
+    EigenRowVector x0Best = (matQ0best_.row(rBest).array() + real(1.)) / real(2.);
+    EigenRowVector x1Best = (matQ1best_.row(rBest).array() + real(1.)) / real(2.);
+    *x0 = Bits(x0Best.template cast<char>());
+    *x1 = Bits(x1Best.template cast<char>());
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::getSwapAcceptanceRates(Vector *rates) const {
+    ladder_.getAcceptanceRates(rates);
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::resetStatistics() {
+    ladder_.resetStatistics();
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::syncFields() {
+    matF0_ = matQ1_ * J_;
+    matF1_ = matQ0_ * Jt_;
+    Ereplica_.resize(nReplicas_);
+    Vector h0(h0_), h1(h1_), E(Ereplica_);
+    Matrix J(J_), q0(matQ0_), q1(matQ1_);
+    BGFuncs<real>::calculate_E(&E, h0, h1, J, c_, q0, q1);
+    for (int r = 0; r < IdxType(nReplicas_); ++r)
+        updateBest(r, Ereplica_(r));
+    fieldsValid_ = true;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::updateBest(IdxType r, real E) {
+    if (E < Ebest_(r)) {
+        Ebest_(r) = E;
+        matQ0best_.row(r) = matQ0_.row(r);
+        matQ1best_.row(r) = matQ1_.row(r);
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::sweepReplica(IdxType r, SizeType nSweeps,
+                                                            SweepRandom<real> &sweepRandom) {
+    real kT = ladder_.kT(r);
+    real *q0 = &matQ0_(r, 0), *q1 = &matQ1_(r, 0);
+    const real *field0 = &matF0_(r, 0), *field1 = &matF1_(r, 0);
+    real E = Ereplica_(r);
+    int N = IdxType(N0_ + N1_);
+
+    /* x in [0, N0) flips q0(x), and x in [N0, N0 + N1) flips q1(x - N0). */
+    sweepRandom.draw(randomPool_[r], N, nSweeps, sweepSequential, std::max(N0_, N1_));
+    for (int loop = 0; loop < N * IdxType(nSweeps); ++loop) {
+        int x = sweepRandom.x(loop);
+        if (x < IdxType(N0_)) {
+            real dE = real(-2.) * q0[x] * (h0_(x) + field0[x]);
+            if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+                q0[x] = - q0[x];
+                matF1_.row(r) += (real(2.) * q0[x]) * Jt_.row(x);
+                E += dE;
+            }
+        }
+        else {
+            int y = x - IdxType(N0_);
+            real dE = real(-2.) * q1[y] * (h1_(y) + field1[y]);
+            if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+                q1[y] = - q1[y];
+                matF0_.row(r) += (real(2.) * q1[y]) * J_.row(y);
+                E += dE;
+            }
+        }
+        if (x == N - 1)
+            updateBest(r, E);
+    }
+    Ereplica_(r) = E;
+}
+
+template<class real>
+void CPUBipartiteGraphParallelTempering<real>::syncBits() {
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    E_.resize(nReplicas_);
+    bitsPairX_.clear();
+    for (int iTemp = 0; iTemp < IdxType(nReplicas_); ++iTemp) {
+        IdxType r = ladder_.replicaAt(iTemp);
+        E_(iTemp) = sign * Ereplica_(r);
+        EigenRowVector x0 = (matQ0_.row(r).array() + real(1.)) / real(2.);
+        EigenRowVector x1 = (matQ1_.row(r).array() + real(1.)) / real(2.);
+        bitsPairX_.pushBack(BitsPairArray::ValueType(Bits(x0.template cast<char>()),
+                                                     Bits(x1.template cast<char>())));
+    }
+}
+
+
+template class sqaod::CPUBipartiteGraphParallelTempering<float>;
+template class sqaod::CPUBipartiteGraphParallelTempering<double>;
@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+#ifndef CPU_BIPARTITEGRAPHPARALLELTEMPERING_H__
+#define CPU_BIPARTITEGRAPHPARALLELTEMPERING_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+#include <cpu/ReplicaExchange.h>
+
+namespace sqaod {
+
+/* Parallel tempering (replica exchange Monte Carlo) of a bipartite graph problem.
+ * A sweep flips spins of q0 and then of q1 with Metropolis acceptance, and replicas
+ * exchange temperatures after every nSweeps sweeps.
+ * Energies are E = c + h0 * q0 + h1 * q1 + q1^T * J * q0 with (h0, h1, J, c) given by BGFuncs. */
+template<class real>
+class CPUBipartiteGraphParallelTempering {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUBipartiteGraphParallelTempering();
+    ~CPUBipartiteGraphParallelTempering();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N0, SizeType *N1, SizeType *nReplicas) const;
+
+    void setProblem(const Vector &b0, const Vector &b1, const Matrix &W, OptimizeMethod om);
+
+    /* kT in ascending order, a replica per temperature. */
+    void setTemperatures(const Vector &kT);
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    /* E and x of replicas ordered by temperatures. */
+    const Vector &get_E() const;
+
+    const BitsPairArray &get_x() const;
+
+    void randomize_q();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    /* runs nExchanges rounds of nSweeps sweeps of all replicas and an exchange. */
+    void run(SizeType nExchanges, SizeType nSweeps);
+
+    /* the lowest E (the highest for optMaximize) and its x found after the last
+     * randomize_q(). */
+    void getBest(real *E, Bits *x0, Bits *x1) const;
+
+    /* accepted / attempted swaps between adjacent temperatures, nReplicas - 1 elements. */
+    void getSwapAcceptanceRates(Vector *rates) const;
+
+    void resetStatistics();
+
+private:
+    void syncBits();
+
+    void syncFields();
+
+    void updateBest(IdxType r, real E);
+
+    void sweepReplica(IdxType r, SizeType nSweeps, SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    bool fieldsValid_;
+
+    Random random_;
+    Random *randomPool_;
+    unsigned long seed_;
+    int nThreads_;
+    SizeType N0_, N1_, nReplicas_;
+    OptimizeMethod om_;
+    EigenRowVector h0_, h1_;
+    /* J_ is (N1, N0), and Jt_ is its transpose to update fields of q1 by rows. */
+    EigenMatrix J_, Jt_;
+    real c_;
+    ReplicaExchange<real> ladder_;
+    /* spins and fields, matF0_ = q1 * J and matF1_ = q0 * J^T, of replicas. */
+    EigenMatrix matQ0_, matQ1_, matF0_, matF1_;
+    EigenRowVector Ereplica_;
+    /* the best of each replica. */
+    EigenRowVector Ebest_;
+    EigenMatrix matQ0best_, matQ1best_;
+    Vector E_;
+    BitsPairArray bitsPairX_;
+
+    CPUBipartiteGraphParallelTempering(const CPUBipartiteGraphParallelTempering &);
+    CPUBipartiteGraphParallelTempering &operator=(const CPUBipartiteGraphParallelTempering &);
+};
+
+}
+
+#endif
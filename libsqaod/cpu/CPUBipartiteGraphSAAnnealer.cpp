@@ -0,0 +1,291 @@
+#include "CPUBipartiteGraphSAAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+#include <algorithm>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUBipartiteGraphSAAnnealer<real>::CPUBipartiteGraphSAAnnealer() {
+    N0_ = N1_ = m_ = 0;
+    annState_ = annNone;
+    sweepOrder_ = sweepSequential;
+    localFieldsValid_ = false;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
+}
+
+template<class real>
+CPUBipartiteGraphSAAnnealer<real>::~CPUBipartiteGraphSAAnnealer() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::seed(unsigned long seed) {
+    random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx)
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::getProblemSize(SizeType *N0, SizeType *N1,
+                                                       SizeType *m) const {
+    *N0 = N0_;
+    *N1 = N1_;
+    *m = m_;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::setProblem(const Vector &b0, const Vector &b1,
+                                                   const Matrix &W, OptimizeMethod om) {
+    THROW_IF((W.rows != b1.size) || (W.cols != b0.size), "Shape of W does not match b0 and b1.");
+    N0_ = b0.size;
+    N1_ = b1.size;
+    h0_.resize(N0_);
+    h1_.resize(N1_);
+    J_.resize(N1_, N0_);
+    Vector h0(h0_), h1(h1_);
+    Matrix J(J_);
+    BGFuncs<real>::calculate_hJc(&h0, &h1, &J, &c_, b0, b1, W);
+
+    om_ = om;
+    if (om_ == optMaximize) {
+        h0_ *= real(-1.);
+        h1_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    Jt_ = J_.transpose();
+    localFieldsValid_ = false;
+    if (annState_ & annNTrottersGiven)
+        setNumRestarts(m_);
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::setNumRestarts(SizeType m) {
+    THROW_IF(m == 0, "The number of restarts must be a positive integer.");
+    m_ = m;
+    bitsPairX_.reserve(m_);
+    bitsPairQ_.reserve(m_);
+    matQ0_.resize(m_, N0_);
+    matQ1_.resize(m_, N1_);
+    E_.resize(m_);
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::setSweepOrder(SweepOrder order) {
+    switch (order) {
+    case sweepRandom:
+    case sweepPermutation:
+    case sweepBlocked:
+        sweepOrder_ = order;
+        break;
+    default:
+        sweepOrder_ = sweepSequential;
+        break;
+    }
+}
+
+template<class real>
+SweepOrder CPUBipartiteGraphSAAnnealer<real>::getSweepOrder() const {
+    return sweepOrder_;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int CPUBipartiteGraphSAAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const VectorType<real> &CPUBipartiteGraphSAAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitsPairArray &CPUBipartiteGraphSAAnnealer<real>::get_x() const {
+    return bitsPairX_;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::set_x(const Bits &x0, const Bits &x1) {
+    THROW_IF((x0.size != N0_) || (x1.size != N1_), "Dimension of x0 or x1 does not match.");
+    EigenRowVector ex0 = x0.mapToRowVector().template cast<real>();
+    EigenRowVector ex1 = x1.mapToRowVector().template cast<real>();
+    matQ0_.rowwise() = (ex0.array() * 2 - 1).matrix();
+    matQ1_.rowwise() = (ex1.array() * 2 - 1).matrix();
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::get_hJc(Vector *h0, Vector *h1,
+                                                Matrix *J, real *c) const {
+    h0->mapToRowVector() = h0_;
+    h1->mapToRowVector() = h1_;
+    J->map() = J_;
+    *c = c_;
+}
+
+template<class real>
+const BitsPairArray &CPUBipartiteGraphSAAnnealer<real>::get_q() const {
+    return bitsPairQ_;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::randomize_q() {
+    real *q = matQ0_.data();
+    for (int idx = 0; idx < IdxType(N0_ * m_); ++idx)
+        q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    q = matQ1_.data();
+    for (int idx = 0; idx < IdxType(N1_ * m_); ++idx)
+        q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::calculate_E() {
+    BGFuncs<real>::calculate_E(&E_, h0_, h1_, J_, c_, matQ0_, matQ1_);
+    if (om_ == optMaximize)
+        E_.mapToRowVector() *= real(-1.);
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annNTrottersGiven))
+        setNumRestarts(std::max((N0_ + N1_) / 4, SizeType(1)));
+    if (!(annState_ & annQSet))
+        randomize_q();
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::syncLocalFields() {
+    matF0_.noalias() = matQ1_ * J_;
+    matF1_.noalias() = matQ0_ * Jt_;
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::annealOneStep(real G, real kT) {
+    real T = std::max(G, kT);
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+#pragma omp parallel num_threads(nThreads_)
+    {
+        Random &random = randomPool_[getThreadNum()];
+        SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+        for (int y = 0; y < IdxType(m_); ++y)
+            annealRestart(y, T, random, sweepRandom);
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::annealRestart(int y, real kT, Random &random,
+                                                      SweepRandom<real> &sweepRandom) {
+    real *q0 = &matQ0_(y, 0), *q1 = &matQ1_(y, 0);
+    const real *field0 = &matF0_(y, 0), *field1 = &matF1_(y, 0);
+    int N = IdxType(N0_ + N1_);
+
+    /* x in [0, N0) flips q0(x), and x in [N0, N0 + N1) flips q1(x - N0). */
+    sweepRandom.draw(random, N, 1, sweepOrder_, std::max(N0_, N1_));
+    for (int loop = 0; loop < N; ++loop) {
+        int x = sweepRandom.x(loop);
+        if (x < IdxType(N0_)) {
+            real dE = real(-2.) * q0[x] * (h0_(x) + field0[x]);
+            if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+                q0[x] = - q0[x];
+                matF1_.row(y) += (real(2.) * q0[x]) * Jt_.row(x);
+            }
+        }
+        else {
+            int x1 = x - IdxType(N0_);
+            real dE = real(-2.) * q1[x1] * (h1_(x1) + field1[x1]);
+            if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+                q1[x1] = - q1[x1];
+                matF0_.row(y) += (real(2.) * q1[x1]) * J_.row(x1);
+            }
+        }
+    }
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::anneal(real *E, Bits *x0, Bits *x1,
+                                               real Ginit, real Gfin, real kT, real tau,
+                                               SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    real Ebest = FLT_MAX;
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        for (real G = Ginit; Gfin < G; G *= tau)
+            annealOneStep(G, kT);
+        finAnneal();
+        for (int idx = 0; idx < IdxType(m_); ++idx) {
+            if (sign * E_(idx) < Ebest) {
+                Ebest = sign * E_(idx);
+                *x0 = bitsPairX_[idx].first;
+                *x1 = bitsPairX_[idx].second;
+            }
+        }
+    }
+    *E = sign * Ebest;
+}
+
+template<class real>
+void CPUBipartiteGraphSAAnnealer<real>::syncBits() {
+    bitsPairX_.clear();
+    bitsPairQ_.clear();
+    for (int idx = 0; idx < IdxType(m_); ++idx) {
+        EigenBitMatrix eq0 = matQ0_.transpose().col(idx).template cast<char>();
+        EigenBitMatrix eq1 = matQ1_.transpose().col(idx).template cast<char>();
+        bitsPairQ_.pushBack(BitsPairArray::ValueType(Bits(eq0), Bits(eq1)));
+        Bits x0 = Bits((eq0.array() + 1) / 2);
+        Bits x1 = Bits((eq1.array() + 1) / 2);
+        bitsPairX_.pushBack(BitsPairArray::ValueType(x0, x1));
+    }
+}
+
+
+template class sqaod::CPUBipartiteGraphSAAnnealer<float>;
+template class sqaod::CPUBipartiteGraphSAAnnealer<double>;
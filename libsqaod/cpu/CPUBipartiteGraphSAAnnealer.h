@@ -0,0 +1,102 @@
+/* -*- c++ -*- */
+#ifndef CPU_BIPARTITEGRAPHSAANNEALER_H__
+#define CPU_BIPARTITEGRAPHSAANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* classical simulated annealing of a bipartite graph problem with the interface of
+ * CPUBipartiteGraphAnnealer.  m independent restarts are annealed in parallel, and a
+ * sweep visits spins of both layers.  The temperature of a step is max(G, kT). */
+template<class real>
+class CPUBipartiteGraphSAAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUBipartiteGraphSAAnnealer();
+    ~CPUBipartiteGraphSAAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N0, SizeType *N1, SizeType *m) const;
+
+    void setProblem(const Vector &b0, const Vector &b1, const Matrix &W, OptimizeMethod om);
+
+    /* the number of restarts, (N0 + N1) / 4 by default. */
+    void setNumRestarts(SizeType m);
+
+    /* sweepSequential (default), sweepRandom, sweepPermutation or sweepBlocked. */
+    void setSweepOrder(SweepOrder order);
+
+    SweepOrder getSweepOrder() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    const Vector &get_E() const;
+
+    const BitsPairArray &get_x() const;
+
+    void set_x(const Bits &x0, const Bits &x1);
+
+    void get_hJc(Vector *h0, Vector *h1, Matrix *J, real *c) const;
+
+    const BitsPairArray &get_q() const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules, G = Ginit * tau^n while Gfin < G,
+     * and returns the best E and (x0, x1) found across repeats. */
+    void anneal(real *E, Bits *x0, Bits *x1,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+private:
+    void syncBits();
+
+    void seedRandomPool();
+
+    /* local fields from the other layer, matF0_ = q1 * J, matF1_ = q0 * J^T,
+     * updated only when a flip is accepted. */
+    void syncLocalFields();
+
+    void annealRestart(int y, real kT, Random &random, SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    SweepOrder sweepOrder_;
+    bool localFieldsValid_;
+
+    Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SizeType N0_, N1_, m_;
+    OptimizeMethod om_;
+    Vector E_;
+    BitsPairArray bitsPairX_;
+    BitsPairArray bitsPairQ_;
+    EigenMatrix matQ0_, matQ1_;
+    EigenMatrix matF0_, matF1_;
+    EigenRowVector h0_, h1_;
+    /* J_ is (N1, N0), and Jt_ is its transpose to update matF1_ by rows. */
+    EigenMatrix J_, Jt_;
+    real c_;
+};
+
+}
+
+#endif
@@ -1,6 +1,9 @@
 #include "CPUDenseGraphAnnealer.h"
 #include "CPUFormulas.h"
 #include <common/Common.h>
+#include <time.h>
+#include <float.h>
+#include <algorithm>
 
 namespace sqd = sqaod;
 
@@ -9,18 +12,45 @@ template<class real>
 sqd::CPUDenseGraphAnnealer<real>::CPUDenseGraphAnnealer() {
     m_ = -1;
     annState_ = annNone;
+    algo_ = algoLocalField;
+    sweepOrder_ = sweepRandom;
+    localFieldsValid_ = false;
+    qPacked_ = false;
+    EtrotterValid_ = false;
+    nFlips_ = 0;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
 }
 
 template<class real>
 sqd::CPUDenseGraphAnnealer<real>::~CPUDenseGraphAnnealer() {
+    delete [] randomPool_;
 }
 
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::seed(unsigned long seed) {
     random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
     annState_ |= annRandSeedGiven;
 }
 
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::setRandomBackend(RandomBackend backend) {
+    random_.setBackend(backend);
+    random_.seed(seed_);
+    seedRandomPool();
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        randomPool_[idx].setBackend(random_.getBackend());
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+    }
+}
+
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::getProblemSize(SizeType *N, SizeType *m) const {
     *N = N_;
@@ -33,6 +63,8 @@ void sqd::CPUDenseGraphAnnealer<real>::setProblem(const Matrix &W, OptimizeMetho
     N_ = W.rows;
     h_.resize(1, N_);
     J_.resize(N_, N_);
+    localFieldsValid_ = false;
+    EtrotterValid_ = false;
 
     Vector h(h_);
     Matrix J(J_);
@@ -43,6 +75,10 @@ void sqd::CPUDenseGraphAnnealer<real>::setProblem(const Matrix &W, OptimizeMetho
         J_ *= real(-1.);
         c_ *= real(-1.);
     }
+    EigenMatrix J4 = real(4.) * J_;
+    packedJ_.set(J4);
+    qPacked_ = false;
+    boltzmann_.set(h_, J_);
 }
 
 template<class real>
@@ -52,9 +88,70 @@ void sqd::CPUDenseGraphAnnealer<real>::setNumTrotters(SizeType m) {
     bitsQ_.reserve(m_);
     matQ_.resize(m_, N_);;
     E_.resize(m_);
+    Etrotter_.resize(m_);
+    localFieldsValid_ = false;
+    qPacked_ = false;
+    EtrotterValid_ = false;
     annState_ |= annNTrottersGiven;
 }
 
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::selectAlgorithm(Algorithm algo) {
+    switch (algo) {
+    case algoNaive:
+    case algoLocalField:
+    case algoColoring:
+    case algoBitPacked:
+        algo_ = algo;
+        break;
+    default:
+        algo_ = algoLocalField;
+        break;
+    }
+}
+
+template<class real>
+sqd::Algorithm sqd::CPUDenseGraphAnnealer<real>::getAlgorithm() const {
+    if ((algo_ == algoBitPacked) && !packedJ_.isSet())
+        return algoLocalField;
+    return algo_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::setSweepOrder(SweepOrder order) {
+    switch (order) {
+    case sweepSequential:
+    case sweepPermutation:
+    case sweepBlocked:
+        sweepOrder_ = order;
+        break;
+    default:
+        sweepOrder_ = sweepRandom;
+        break;
+    }
+}
+
+template<class real>
+sqd::SweepOrder sqd::CPUDenseGraphAnnealer<real>::getSweepOrder() const {
+    return sweepOrder_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int sqd::CPUDenseGraphAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
 template<class real>
 const sqd::VectorType<real> &sqd::CPUDenseGraphAnnealer<real>::get_E() const {
     return E_;
@@ -69,6 +166,10 @@ template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::set_x(const Bits &x) {
     EigenRowVector ex = x.mapToRowVector().cast<real>();
     matQ_.rowwise() = (ex.array() * 2 - 1).matrix();
+    localFieldsValid_ = false;
+    qPacked_ = false;
+    EtrotterValid_ = false;
+    monitor_.reset();
     annState_ |= annQSet;
 }
 
@@ -89,13 +190,17 @@ void sqd::CPUDenseGraphAnnealer<real>::randomize_q() {
     real *q = matQ_.data();
     for (int idx = 0; idx < IdxType(N_ * m_); ++idx)
         q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    localFieldsValid_ = false;
+    qPacked_ = false;
+    EtrotterValid_ = false;
+    monitor_.reset();
     annState_ |= annQSet;
 }
 
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::initAnneal() {
     if (!(annState_ & annRandSeedGiven))
-        random_.seed();
+        seed((unsigned long)time(NULL));
     annState_ |= annRandSeedGiven;
     if (!(annState_ & annNTrottersGiven))
         setNumTrotters((N_) / 4);
@@ -114,6 +219,7 @@ void sqd::CPUDenseGraphAnnealer<real>::finAnneal() {
 
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::calculate_E() {
+    unpackSpins();
     DGFuncs<real>::calculate_E(&E_, h_, J_, c_, matQ_);
     if (om_ == sqd::optMaximize)
         E_.mapToRowVector() *= real(-1.);
@@ -123,6 +229,7 @@ void sqd::CPUDenseGraphAnnealer<real>::calculate_E() {
 
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::syncBits() {
+    unpackSpins();
     bitsX_.clear();
     bitsQ_.clear();
     for (int idx = 0; idx < IdxType(m_); ++idx) {
@@ -137,21 +244,290 @@ void sqd::CPUDenseGraphAnnealer<real>::syncBits() {
 
 template<class real>
 void sqd::CPUDenseGraphAnnealer<real>::annealOneStep(real G, real kT) {
+    Algorithm algo = getAlgorithm();
+    if (algo != algoBitPacked)
+        unpackSpins();
+
+    nFlips_ = 0;
+    switch (algo) {
+    case algoBitPacked:
+        annealOneStepBitPacked(G, kT);
+        break;
+    case algoNaive:
+        annealOneStepNaive(G, kT);
+        break;
+    case algoColoring:
+        annealOneStepColoring(G, kT);
+        break;
+    case algoLocalField:
+    default:
+        annealOneStepLocalField(G, kT);
+        break;
+    }
+    if (monitor_.tracksEnergy())
+        monitor_.update(nFlips_, (unsigned long long)N_ * m_, calculateEmin());
+    else
+        monitor_.update(nFlips_, (unsigned long long)N_ * m_);
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::anneal(real *E, Bits *x,
+                                             real Ginit, real Gfin, real kT, real tau,
+                                             SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == sqd::optMaximize) ? real(-1.) : real(1.);
+    real Ebest = FLT_MAX;
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        for (real G = Ginit; (Gfin < G) && !monitor_.isFrozen(); G *= tau)
+            annealOneStep(G, kT);
+        finAnneal();
+        for (int idx = 0; idx < IdxType(m_); ++idx) {
+            if (sign * E_(idx) < Ebest) {
+                Ebest = sign * E_(idx);
+                *x = bitsX_[idx];
+            }
+        }
+    }
+    *E = sign * Ebest;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::setStoppingPolicy(const StoppingPolicy &policy) {
+    THROW_IF(policy.maxAcceptanceRate < 0., "maxAcceptanceRate must not be negative.");
+    monitor_.setPolicy(policy);
+}
+
+template<class real>
+const sqd::StoppingPolicy &sqd::CPUDenseGraphAnnealer<real>::getStoppingPolicy() const {
+    return monitor_.getPolicy();
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::getAnnealStatistics(AnnealStatistics *stats) const {
+    *stats = monitor_.getStatistics();
+    if (om_ == sqd::optMaximize)
+        stats->Ebest = - stats->Ebest;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::getAcceptanceRates(Vector *rates) const {
+    const std::vector<double> &history = monitor_.getAcceptanceRates();
+    rates->resize(SizeType(history.size()));
+    for (int idx = 0; idx < IdxType(history.size()); ++idx)
+        (*rates)(idx) = real(history[idx]);
+}
+
+template<class real>
+real sqd::CPUDenseGraphAnnealer<real>::calculateEmin() {
+    if (!EtrotterValid_) {
+        unpackSpins();
+        if (!localFieldsValid_)
+            syncLocalFields();
+        /* matH_ = q * J + h, thus h * q + q * J * q^T = q * matH_^T per trotter. */
+        Etrotter_ = matQ_.cwiseProduct(matH_).rowwise().sum().transpose();
+        EtrotterValid_ = true;
+    }
+    return c_ + Etrotter_.minCoeff();
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::annealOneStepNaive(real G, real kT) {
+    localFieldsValid_ = false;
     real twoDivM = real(2.) / real(m_);
     real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    bool useTable = boltzmann_.build(twoDivM, coef, kT, N_ * m_);
         
+    sweepRandom_.draw(random_, N_, m_, sweepOrder_, N_);
     for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
-        int x = random_.randInt(N_);
-        int y = random_.randInt(m_);
+        int x = sweepRandom_.x(loop);
+        int y = sweepRandom_.y(loop);
         real qyx = matQ_(y, x);
         real sum = J_.row(x).dot(matQ_.row(y));
-        real dE = - twoDivM * qyx * (h_(x) + sum);
+        real qField = qyx * (h_(x) + sum);
         int neibour0 = (m_ + y - 1) % m_;
         int neibour1 = (y + 1) % m_;
-        dE -= qyx * (matQ_(neibour0, x) + matQ_(neibour1, x)) * coef;
-        real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
-        if (threshold > random_.random<real>())
+        real nbSum = qyx * (matQ_(neibour0, x) + matQ_(neibour1, x));
+        real threshold;
+        if (useTable) {
+            threshold = boltzmann_.threshold(qField, int(nbSum));
+        } else {
+            real dE = - twoDivM * qField - nbSum * coef;
+            threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        }
+        if (threshold > sweepRandom_.uniform(loop)) {
+            matQ_(y, x) = - qyx;
+            Etrotter_(y) -= real(2.) * qyx * (h_(x) + real(2.) * sum);
+            ++nFlips_;
+        }
+    }
+}
+
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::syncLocalFields() {
+    /* J_ is symmetric, so (J * q^T)^T = q * J. */
+    matH_ = matQ_ * J_;
+    matH_.rowwise() += h_;
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::annealOneStepLocalField(real G, real kT) {
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    bool useTable = boltzmann_.build(twoDivM, coef, kT, N_ * m_);
+
+    sweepRandom_.draw(random_, N_, m_, sweepOrder_, N_);
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = sweepRandom_.x(loop);
+        int y = sweepRandom_.y(loop);
+        real qyx = matQ_(y, x);
+        real qField = qyx * matH_(y, x);
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        real nbSum = qyx * (matQ_(neibour0, x) + matQ_(neibour1, x));
+        real threshold;
+        if (useTable) {
+            threshold = boltzmann_.threshold(qField, int(nbSum));
+        } else {
+            real dE = - twoDivM * qField - nbSum * coef;
+            threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        }
+        if (threshold > sweepRandom_.uniform(loop)) {
+            matQ_(y, x) = - qyx;
+            Etrotter_(y) -= real(2.) * qyx * (real(2.) * matH_(y, x) - h_(x));
+            /* diagonal elements of J_ are zero, thus matH_(y, x) stays unchanged. */
+            matH_.row(y) -= (real(2.) * qyx) * J_.row(x);
+            ++nFlips_;
+        }
+    }
+}
+
+
+template<class real>
+int sqd::CPUDenseGraphAnnealer<real>::annealTrotter(int y, real G, real kT, bool useTable,
+                                                   Random &random) {
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    int neibour0 = (m_ + y - 1) % m_;
+    int neibour1 = (y + 1) % m_;
+    int nFlips = 0;
+
+    for (int loop = 0; loop < IdxType(N_); ++loop) {
+        int x = (sweepOrder_ == sweepRandom) ? IdxType(random.randInt(N_)) : loop;
+        real qyx = matQ_(y, x);
+        real qField = qyx * matH_(y, x);
+        real nbSum = qyx * (matQ_(neibour0, x) + matQ_(neibour1, x));
+        real threshold;
+        if (useTable) {
+            threshold = boltzmann_.threshold(qField, int(nbSum));
+        } else {
+            real dE = - twoDivM * qField - nbSum * coef;
+            threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        }
+        if (threshold > random.random<real>()) {
             matQ_(y, x) = - qyx;
+            Etrotter_(y) -= real(2.) * qyx * (real(2.) * matH_(y, x) - h_(x));
+            matH_.row(y) -= (real(2.) * qyx) * J_.row(x);
+            ++nFlips;
+        }
+    }
+    return nFlips;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::annealOneStepColoring(real G, real kT) {
+    if (!localFieldsValid_)
+        syncLocalFields();
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    /* threads only read the table. */
+    bool useTable = boltzmann_.buildAll(twoDivM, coef, kT, N_ * m_);
+
+    /* Trotters only interact with their neighbours (y +/- 1), so trotters of the same
+     * color are independent.  With odd m, the last trotter neighbours trotter 0, and
+     * is annealed in its own phase. */
+    int nEvenTrotters = (m_ % 2 == 0) ? IdxType(m_) : std::max(IdxType(m_) - 1, 1);
+    int phaseEnd[] = { nEvenTrotters, nEvenTrotters, IdxType(m_) };
+    int phaseBegin[] = { 0, 1, nEvenTrotters };
+    int phaseStride[] = { 2, 2, 1 };
+
+    for (int phase = 0; phase < 3; ++phase) {
+        if (phaseEnd[phase] <= phaseBegin[phase])
+            continue;
+        int nTrotters = (phaseEnd[phase] - phaseBegin[phase] + phaseStride[phase] - 1) / phaseStride[phase];
+        unsigned long long nFlips = 0;
+#pragma omp parallel num_threads(nThreads_)
+        {
+            Random &random = randomPool_[getThreadNum()];
+#pragma omp for schedule(static) reduction(+:nFlips)
+            for (int idx = 0; idx < nTrotters; ++idx) {
+                int y = phaseBegin[phase] + idx * phaseStride[phase];
+                nFlips += annealTrotter(y, G, kT, useTable, random);
+            }
+        }
+        nFlips_ += nFlips;
+    }
+}
+
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::packSpins() {
+    if (qPacked_)
+        return;
+    packedQ_.pack(matQ_);
+    qPacked_ = true;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::unpackSpins() {
+    if (!qPacked_)
+        return;
+    packedQ_.unpack(&matQ_);
+    localFieldsValid_ = false;
+    qPacked_ = false;
+}
+
+template<class real>
+void sqd::CPUDenseGraphAnnealer<real>::annealOneStepBitPacked(real G, real kT) {
+    packSpins();
+
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    bool useTable = boltzmann_.build(twoDivM, coef, kT, N_ * m_);
+
+    sweepRandom_.draw(random_, N_, m_, sweepOrder_, N_);
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = sweepRandom_.x(loop);
+        int y = sweepRandom_.y(loop);
+        real qyx = packedQ_.get(y, x) ? real(1.) : real(-1.);
+        real field = h_(x) + real(0.25) * real(packedJ_.dot(x, packedQ_.row(y)));
+        real qField = qyx * field;
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        /* qyx * (q(neibour0, x) + q(neibour1, x)) = 2 - 2 * (number of disagreements) */
+        int nDisagreements = packedQ_.countDisagreements(y, neibour0, neibour1, x);
+        int nbSum = 2 - 2 * nDisagreements;
+        real threshold;
+        if (useTable) {
+            threshold = boltzmann_.threshold(qField, nbSum);
+        } else {
+            real dE = - twoDivM * qField - real(nbSum) * coef;
+            threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        }
+        if (threshold > sweepRandom_.uniform(loop)) {
+            packedQ_.flip(y, x);
+            Etrotter_(y) -= real(2.) * qyx * (real(2.) * field - h_(x));
+            ++nFlips_;
+        }
     }
 }
 
@@ -4,6 +4,9 @@
 
 #include <common/Common.h>
 #include <cpu/Random.h>
+#include <cpu/PackedSpins.h>
+#include <cpu/BoltzmannTable.h>
+#include <cpu/AnnealMonitor.h>
 
 namespace sqaod {
 
@@ -27,6 +30,26 @@ public:
 
     void setNumTrotters(SizeType m);
 
+    /* algoBitPacked requires integral 4J, that is, integral W.  Otherwise
+     * algoLocalField is used, and getAlgorithm() returns it. */
+    void selectAlgorithm(Algorithm algo);
+
+    Algorithm getAlgorithm() const;
+
+    /* rngMT19937 (default), rngXoshiro256 or rngPhilox.  Random numbers are
+     * reseeded with the last seed given. */
+    void setRandomBackend(RandomBackend backend);
+
+    /* sweepRandom (default), sweepSequential, sweepPermutation or sweepBlocked.
+     * With algoColoring, orders other than sweepRandom visit spins of a trotter in order. */
+    void setSweepOrder(SweepOrder order);
+
+    SweepOrder getSweepOrder() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
     const Vector &get_E() const;
 
     const BitsArray &get_x() const;
@@ -46,21 +69,82 @@ public:
     void finAnneal();
 
     void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules, G = Ginit * tau^n while Gfin < G,
+     * and returns the best E and x found across repeats.  A schedule ends early
+     * once annealing is frozen under the stopping policy. */
+    void anneal(real *E, Bits *x,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+    /* steps are tracked from randomize_q() or set_x(). */
+    void setStoppingPolicy(const StoppingPolicy &policy);
+
+    const StoppingPolicy &getStoppingPolicy() const;
+
+    /* Ebest is given in the direction of optimization. */
+    void getAnnealStatistics(AnnealStatistics *stats) const;
+
+    /* acceptance rates of steps tracked. */
+    void getAcceptanceRates(Vector *rates) const;
     
 private:    
     void syncBits();
+
+    void annealOneStepNaive(real G, real kT);
+
+    /* local fields, matH_(y, x) = h(x) + J.row(x).dot(matQ_.row(y)),
+     * are updated only when a flip is accepted. */
+    void syncLocalFields();
+    void annealOneStepLocalField(real G, real kT);
+
+    /* trotters are split into even / odd colors, and trotters in a color
+     * are annealed in parallel, each thread with its own random stream. */
+    void annealOneStepColoring(real G, real kT);
+    /* returns the number of flips. */
+    int annealTrotter(int y, real G, real kT, bool useTable, Random &random);
+    void seedRandomPool();
+
+    /* spins are packed to bits, and fields are calculated by popcounts over
+     * bit-planes of 4J.  matQ_ is synchronized lazily. */
+    void annealOneStepBitPacked(real G, real kT);
+    void packSpins();
+    void unpackSpins();
+
+    /* the lowest energy among trotters in the minimizing direction.  Energies of trotters
+     * are calculated once after q is set, and followed by dE of accepted flips. */
+    real calculateEmin();
+
     int annState_;
+    Algorithm algo_;
+    SweepOrder sweepOrder_;
+    bool localFieldsValid_;
     
     Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SweepRandom<real> sweepRandom_;
     SizeType N_, m_;
     OptimizeMethod om_;
     Vector E_;
     BitsArray bitsX_;
     BitsArray bitsQ_;
     EigenMatrix matQ_;
+    EigenMatrix matH_;
     EigenRowVector h_;
     EigenMatrix J_;
     real c_;
+    PackedSpinMatrix packedQ_;
+    BitPlaneCouplings packedJ_;
+    bool qPacked_;
+    /* h * q + q * J * q^T of each trotter, without c. */
+    EigenRowVector Etrotter_;
+    bool EtrotterValid_;
+    /* replaces exp() in all algorithms if fields are integral, as for integral W. */
+    BoltzmannTable<real> boltzmann_;
+    /* flips accepted in the current step */
+    unsigned long long nFlips_;
+    AnnealMonitor monitor_;
 };
 
 }
@@ -10,10 +10,17 @@ using namespace sqaod;
 template<class real>
 CPUDenseGraphBFSolver<real>::CPUDenseGraphBFSolver() {
     tileSize_ = 1024;
+    topK_ = 1;
+    maxNumMinStates_ = 1 << 16;
+    nMinStates_ = 0;
+    algo_ = algoBatchSearch;
+    nThreads_ = getDefaultNumThreads();
+    searchers_ = new Searcher[nThreads_];
 }
 
 template<class real>
 CPUDenseGraphBFSolver<real>::~CPUDenseGraphBFSolver() {
+    delete [] searchers_;
 }
 
 
@@ -31,10 +38,49 @@ template<class real>
 void CPUDenseGraphBFSolver<real>::setProblem(const Matrix &W, OptimizeMethod om) {
     THROW_IF(!isSymmetric(W), "W is not symmetric.");
     N_ = W.rows;
-    W_ = W.map();
+    Wfull_ = W.map();
     om_ = om;
     if (om_ == optMaximize)
-        W_ *= real(-1.);
+        Wfull_ *= real(-1.);
+    clearClampedBits();
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::setClampedBits(const Bits &mask, const Bits &x) {
+    THROW_IF((mask.size != N_) || (x.size != N_), "Dimension of mask or x does not match N.");
+    std::vector<IdxType> freePos, onPos;
+    for (IdxType pos = 0; pos < (IdxType)N_; ++pos) {
+        if (mask(pos) == 0)
+            freePos.push_back(pos);
+        else if (x(pos) != 0)
+            onPos.push_back(pos);
+    }
+    THROW_IF(63 < freePos.size(), "# of free bits must be less than 64.");
+    subSpace_.set(x, freePos);
+
+    /* E = xf^T Wff xf + 2 xc^T Wcf xf + xc^T Wcc xc, and xf(i)^2 = xf(i) for bits. */
+    int nFree = (int)freePos.size();
+    W_.resize(nFree, nFree);
+    for (int j = 0; j < nFree; ++j) {
+        real sum = real(0.);
+        for (size_t iOn = 0; iOn < onPos.size(); ++iOn)
+            sum += Wfull_(freePos[j], onPos[iOn]);
+        for (int i = 0; i < nFree; ++i)
+            W_(j, i) = Wfull_(freePos[j], freePos[i]);
+        W_(j, j) += real(2.) * sum;
+    }
+    Ec_ = real(0.);
+    for (size_t jOn = 0; jOn < onPos.size(); ++jOn) {
+        for (size_t iOn = 0; iOn < onPos.size(); ++iOn)
+            Ec_ += Wfull_(onPos[jOn], onPos[iOn]);
+    }
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::clearClampedBits() {
+    subSpace_.setFullSpace(N_);
+    W_ = Wfull_;
+    Ec_ = real(0.);
 }
 
 template<class real>
@@ -42,6 +88,58 @@ void CPUDenseGraphBFSolver<real>::setTileSize(SizeType tileSize) {
     tileSize_ = tileSize;
 }
 
+template<class real>
+void CPUDenseGraphBFSolver<real>::setTopK(SizeType K) {
+    THROW_IF(K == 0, "K must be a positive integer.");
+    topK_ = K;
+}
+
+template<class real>
+SizeType CPUDenseGraphBFSolver<real>::getTopK() const {
+    return topK_;
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::setMaxNumMinStates(SizeType maxNumMinStates) {
+    maxNumMinStates_ = maxNumMinStates;
+}
+
+template<class real>
+unsigned long long CPUDenseGraphBFSolver<real>::getNumMinStates() const {
+    return nMinStates_;
+}
+
+template<class real>
+real CPUDenseGraphBFSolver<real>::getMinE() const {
+    real E = minE_ + Ec_;
+    return (om_ == optMaximize) ? - E : E;
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::selectAlgorithm(Algorithm algo) {
+    algo_ = (algo == algoGrayCode) ? algoGrayCode : algoBatchSearch;
+}
+
+template<class real>
+Algorithm CPUDenseGraphBFSolver<real>::getAlgorithm() const {
+    return algo_;
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] searchers_;
+    nThreads_ = nThreads;
+    searchers_ = new Searcher[nThreads_];
+}
+
+template<class real>
+int CPUDenseGraphBFSolver<real>::getNumThreads() const {
+    return nThreads_;
+}
+
 template<class real>
 const BitsArray &CPUDenseGraphBFSolver<real>::get_x() const {
     return xList_;
@@ -55,41 +153,117 @@ const VectorType<real> &CPUDenseGraphBFSolver<real>::get_E() const {
 template<class real>
 void CPUDenseGraphBFSolver<real>::initSearch() {
     minE_ = FLT_MAX;
+    nMinStates_ = 0;
     packedXList_.clear();
     xList_.clear();
-    xMax_ = 1ull << N_;
+    xMax_ = subSpace_.getNumStates();
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        searchers_[idx].minStates.setCapacity(maxNumMinStates_);
+        searchers_[idx].topK.setCapacity(topK_);
+    }
 }
 
 
 template<class real>
 void CPUDenseGraphBFSolver<real>::finSearch() {
+    if (1 < topK_) {
+        finSearchTopK();
+        return;
+    }
+    /* reduction */
+    for (int idx = 0; idx < nThreads_; ++idx)
+        minE_ = std::min(minE_, searchers_[idx].minStates.getEmin());
+    packedXList_.clear();
+    nMinStates_ = 0;
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        const MinStateList &minStates = searchers_[idx].minStates;
+        if (minStates.getEmin() != minE_)
+            continue;
+        nMinStates_ += minStates.getNumStates();
+        for (SizeType iX = 0; iX < minStates.size(); ++iX)
+            packedXList_.pushBack(minStates[iX]);
+    }
+    std::sort(packedXList_.begin(), packedXList_.end());
+    /* each thread stores its smallest maxNumMinStates_ x, thus the smallest x of all are kept. */
+    SizeType nStored = std::min((SizeType)packedXList_.size(), maxNumMinStates_);
+
     xList_.clear();
-    for (int idx = 0; idx < (int)packedXList_.size(); ++idx) {
+    for (int idx = 0; idx < (int)nStored; ++idx) {
         Bits bits;
-        unpackBits(&bits, packedXList_[idx], N_);
+        subSpace_.unpack(&bits, packedXList_[idx]);
         xList_.pushBack(bits);
     }
-    E_.resize((SizeType)packedXList_.size());
-    E_.mapToRowVector().array() = (om_ == optMaximize) ? - minE_ : minE_;
+    E_.resize(nStored);
+    real E = minE_ + Ec_;
+    E_.mapToRowVector().array() = (om_ == optMaximize) ? - E : E;
 }
 
 
+template<class real>
+void CPUDenseGraphBFSolver<real>::finSearchTopK() {
+    /* per-thread heaps are merged to the heap of the first thread. */
+    TopK &topK = searchers_[0].topK;
+    for (int idx = 1; idx < nThreads_; ++idx)
+        topK.merge(searchers_[idx].topK);
+    std::vector<typename TopK::State> states;
+    topK.getSorted(&states);
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    minE_ = states.empty() ? real(FLT_MAX) : states[0].E;
+    packedXList_.clear();
+    xList_.clear();
+    E_.resize((SizeType)states.size());
+    for (int idx = 0; idx < (int)states.size(); ++idx) {
+        packedXList_.pushBack(states[idx].x);
+        Bits bits;
+        subSpace_.unpack(&bits, states[idx].x);
+        xList_.pushBack(bits);
+        E_(idx) = sign * (states[idx].E + Ec_);
+    }
+}
+
 template<class real>
 void CPUDenseGraphBFSolver<real>::searchRange(unsigned long long iBegin, unsigned long long iEnd) {
+    iBegin = std::min(iBegin, xMax_);
+    iEnd = std::min(iEnd, xMax_);
+    if (iEnd <= iBegin)
+        return;
+    PackedBits iStep = std::min(tileSize_, iEnd - iBegin);
+    long long nTiles = (long long)((iEnd - iBegin + iStep - 1) / iStep);
+
+    /* tiles are handed to idle threads one by one. */
+#pragma omp parallel num_threads(nThreads_)
+    {
+        Searcher *searcher = &searchers_[getThreadNum()];
+#pragma omp for schedule(dynamic)
+        for (long long iTile = 0; iTile < nTiles; ++iTile) {
+            PackedBits iTileBegin = iBegin + (PackedBits)iTile * iStep;
+            searchRange(searcher, iTileBegin, std::min(iTileBegin + iStep, (PackedBits)iEnd));
+        }
+    }
+}
+
+template<class real>
+void CPUDenseGraphBFSolver<real>::searchRange(Searcher *searcher, PackedBits iBegin, PackedBits iEnd) {
     iBegin = std::min(std::max(0ULL, iBegin), xMax_);
     iEnd = std::min(std::max(0ULL, iEnd), xMax_);
-    DGFuncs<real>::batchSearch(&minE_, &packedXList_, W_, iBegin, iEnd);
-    /* FIXME: add max limits of # min vectors. */
+    if (1 < topK_) {
+        if (algo_ == algoGrayCode)
+            DGFuncs<real>::batchSearchGrayCode(&searcher->topK, W_, iBegin, iEnd);
+        else
+            DGFuncs<real>::batchSearch(&searcher->topK, W_, iBegin, iEnd);
+        return;
+    }
+    if (algo_ == algoGrayCode)
+        DGFuncs<real>::batchSearchGrayCode(&searcher->minStates, W_, iBegin, iEnd);
+    else
+        DGFuncs<real>::batchSearch(&searcher->minStates, W_, iBegin, iEnd);
 }
 
 template<class real>
 void CPUDenseGraphBFSolver<real>::search() {
-    PackedBits iStep = std::min(tileSize_, xMax_);
-
     initSearch();
-    for (PackedBits iTile = 0; iTile < xMax_; iTile += iStep) {
-        searchRange(iTile, iTile + iStep);
-    }
+    searchRange(0, xMax_);
     finSearch();
 }
 
@@ -1,9 +1,12 @@
 /* -*- c++ -*- */
 #ifndef CPU_DENSEGRAPHBRUTEFORCESOLVER_H__
-#define CPU_DENSEGRAPHANNEALER_H__
+#define CPU_DENSEGRAPHBRUTEFORCESOLVER_H__
 
 #include <common/Common.h>
+#include <common/BitsSubSpace.h>
 #include <cpu/Random.h>
+#include <cpu/TopKStates.h>
+#include <cpu/MinStates.h>
 
 namespace sqaod {
 
@@ -24,8 +27,39 @@ public:
 
     void setProblem(const Matrix &W, OptimizeMethod om);
 
+    /* fixes x(i) for mask(i) != 0, and enumerates other bits, whose number must be less
+     * than 64.  Fixed bits are folded into the diagonal of free bits and a constant, and
+     * get_x() gives whole x.  setProblem() clears fixed bits. */
+    void setClampedBits(const Bits &mask, const Bits &x);
+
+    void clearClampedBits();
+
     void setTileSize(SizeType tileSize);
 
+    /* K = 1 (default) gives all x at the minimum E.  K > 1 gives the K lowest states
+     * in ascending order of E, and ties at the K-th E are broken by smaller x. */
+    void setTopK(SizeType K);
+
+    SizeType getTopK() const;
+
+    /* max # of x stored at the minimum E with K = 1, 65536 by default.  The smallest x
+     * are stored.  Buffers are allocated before search, and 0 only counts minima. */
+    void setMaxNumMinStates(SizeType maxNumMinStates);
+
+    /* # of x at the minimum E found in the last search, including those not stored. */
+    unsigned long long getNumMinStates() const;
+
+    /* minimum E of the last search.  get_E() is empty if no state is stored. */
+    real getMinE() const;
+
+    void selectAlgorithm(Algorithm algo);
+
+    Algorithm getAlgorithm() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
     const BitsArray &get_x() const;
 
     const Vector &get_E() const;
@@ -34,22 +68,49 @@ public:
 
     void finSearch();
 
+    /* searches [iBegin, iEnd) by tiles handed to all threads.  Ranges between
+     * initSearch() and finSearch() can be split so that callers are interruptible.
+     * With algoGrayCode, indices are gray-code positions i of x = i ^ (i >> 1). */
     void searchRange(unsigned long long iBegin, unsigned long long iEnd);
 
     void search();
     
 private:    
+    typedef TopKStates<real, PackedBits> TopK;
+    typedef MinStates<real, PackedBits> MinStateList;
+
+    /* search state of each thread, merged in finSearch(). */
+    struct Searcher {
+        MinStateList minStates;
+        TopK topK;
+    };
+
+    void finSearchTopK();
+
+    void searchRange(Searcher *searcher, PackedBits iBegin, PackedBits iEnd);
+
     Random random_;
     SizeType N_;
+    /* x are enumerated in the sub-space, indexed by PackedBits. */
+    BitsSubSpace subSpace_;
     OptimizeMethod om_;
     PackedBits tileSize_;
+    SizeType topK_;
+    SizeType maxNumMinStates_;
+    unsigned long long nMinStates_;
     PackedBits xMax_;
+    Algorithm algo_;
+    int nThreads_;
+    Searcher *searchers_;
     real minE_;
     Vector E_;
     PackedBitsArray packedXList_;
     BitsArray xList_;
     EigenMatrix matX_;
+    /* W of the whole problem, and W of free bits with the constant of fixed bits. */
+    EigenMatrix Wfull_;
     EigenMatrix W_;
+    real Ec_;
 };
 
 }
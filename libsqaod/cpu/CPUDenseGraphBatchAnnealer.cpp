@@ -0,0 +1,254 @@
+#include "CPUDenseGraphBatchAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUDenseGraphBatchAnnealer<real>::CPUDenseGraphBatchAnnealer() {
+    nProblems_ = 0;
+    N_ = 0;
+    m_ = -1;
+    annState_ = annNone;
+    localFieldsValid_ = false;
+    random_ = NULL;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+}
+
+template<class real>
+CPUDenseGraphBatchAnnealer<real>::~CPUDenseGraphBatchAnnealer() {
+    delete [] random_;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::seed(unsigned long seed) {
+    seed_ = seed;
+    for (int p = 0; p < IdxType(nProblems_); ++p)
+        random_[p].seed(seed_, Random::streamId(p, 0));
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::getProblemSize(SizeType *nProblems,
+                                                      SizeType *N, SizeType *m) const {
+    *nProblems = nProblems_;
+    *N = N_;
+    *m = m_;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::setProblems(const Matrix &Ws, OptimizeMethod om) {
+    THROW_IF((Ws.cols == 0) || (Ws.rows % Ws.cols != 0),
+             "Ws must be (nProblems * N, N).");
+    SizeType nProblems = Ws.rows / Ws.cols;
+    bool reshaped = (nProblems != nProblems_) || (Ws.cols != N_);
+    if (nProblems != nProblems_) {
+        delete [] random_;
+        random_ = new Random[nProblems];
+        nProblems_ = nProblems;
+        if (annState_ & annRandSeedGiven)
+            seed(seed_);
+    }
+    N_ = Ws.cols;
+    h_.resize(nProblems_, N_);
+    J_.resize(nProblems_ * N_, N_);
+    c_.resize(nProblems_);
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        Matrix W, J;
+        W.set(const_cast<real*>(&Ws(p * N_, 0)), N_, N_);
+        J.set(&J_(p * N_, 0), N_, N_);
+        Vector h;
+        h.set(&h_(p, 0), N_);
+        DGFuncs<real>::calculate_hJc(&h, &J, &c_(p), W);
+    }
+    om_ = om;
+    if (om_ == optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    /* q buffers follow the new shape, and q is randomized again. */
+    if (reshaped) {
+        if (annState_ & annNTrottersGiven)
+            setNumTrotters(m_);
+        annState_ &= ~annQSet;
+    }
+    localFieldsValid_ = false;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::setNumTrotters(SizeType m) {
+    THROW_IF(m <= 0, "# trotters must be a positive integer.");
+    m_ = m;
+    matQ_.resize(nProblems_ * m_, N_);
+    matH_.resize(nProblems_ * m_, N_);
+    E_.resize(nProblems_, m_);
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    nThreads_ = nThreads;
+}
+
+template<class real>
+int CPUDenseGraphBatchAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const MatrixType<real> &CPUDenseGraphBatchAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitMatrix &CPUDenseGraphBatchAnnealer<real>::get_x() const {
+    return bitsX_;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::randomize_q() {
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        for (int y = 0; y < IdxType(m_); ++y) {
+            real *q = &matQ_(p * m_ + y, 0);
+            for (int x = 0; x < IdxType(N_); ++x)
+                q[x] = random_[p].randInt(2) ? real(1.) : real(-1.);
+        }
+    }
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::calculate_E() {
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+    for (int p = 0; p < IdxType(nProblems_); ++p) {
+        const EigenMatrix q = matQ_.middleRows(p * m_, m_);
+        EigenMatrix qJ = q * J_.middleRows(p * N_, N_);
+        E_.map().row(p) = sign * ((q * h_.row(p).transpose()).array() + c_(p)
+                                  + qJ.cwiseProduct(q).rowwise().sum().array()).transpose();
+    }
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annNTrottersGiven))
+        setNumTrotters((N_ + 3) / 4);
+    if (!(annState_ & annQSet))
+        randomize_q();
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::annealOneStep(real G, real kT) {
+#pragma omp parallel num_threads(nThreads_)
+    {
+        /* random numbers of a problem are drawn in bulk from its stream. */
+        SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+        for (int p = 0; p < IdxType(nProblems_); ++p) {
+            if (!localFieldsValid_)
+                syncLocalFields(p);
+            annealProblem(p, G, kT, sweepRandom);
+        }
+    }
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::anneal(Vector *E, BitMatrix *x,
+                                              real Ginit, real Gfin, real kT, real tau,
+                                              SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    E->resize(nProblems_);
+    x->resize(nProblems_, N_);
+    EigenRowVector Ebest = EigenRowVector::Constant(nProblems_, FLT_MAX);
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        /* each problem runs the whole schedule while its matrices are in cache. */
+#pragma omp parallel num_threads(nThreads_)
+        {
+            SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+            for (int p = 0; p < IdxType(nProblems_); ++p) {
+                syncLocalFields(p);
+                for (real G = Ginit; Gfin < G; G *= tau)
+                    annealProblem(p, G, kT, sweepRandom);
+            }
+        }
+        localFieldsValid_ = true;
+        finAnneal();
+        for (int p = 0; p < IdxType(nProblems_); ++p) {
+            for (int y = 0; y < IdxType(m_); ++y) {
+                if (sign * E_(p, y) < Ebest(p)) {
+                    Ebest(p) = sign * E_(p, y);
+                    x->map().row(p) = bitsX_.map().row(p * m_ + y);
+                }
+            }
+        }
+    }
+    E->mapToRowVector() = sign * Ebest;
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::syncLocalFields(IdxType p) {
+    /* J is symmetric, so (J * q^T)^T = q * J. */
+    matH_.middleRows(p * m_, m_) = matQ_.middleRows(p * m_, m_) * J_.middleRows(p * N_, N_);
+    matH_.middleRows(p * m_, m_).rowwise() += h_.row(p);
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::annealProblem(IdxType p, real G, real kT,
+                                                     SweepRandom<real> &sweepRandom) {
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    int qOffset = p * m_, jOffset = p * N_;
+
+    sweepRandom.draw(random_[p], N_, m_, sqaod::sweepRandom, N_);
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = sweepRandom.x(loop);
+        int y = sweepRandom.y(loop);
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        real qyx = matQ_(qOffset + y, x);
+        real qField = qyx * matH_(qOffset + y, x);
+        real nbSum = qyx * (matQ_(qOffset + neibour0, x) + matQ_(qOffset + neibour1, x));
+        real dE = - twoDivM * qField - nbSum * coef;
+        real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        if (threshold > sweepRandom.uniform(loop)) {
+            matQ_(qOffset + y, x) = - qyx;
+            matH_.row(qOffset + y) -= (real(2.) * qyx) * J_.row(jOffset + x);
+        }
+    }
+}
+
+template<class real>
+void CPUDenseGraphBatchAnnealer<real>::syncBits() {
+    bitsX_.resize(nProblems_ * m_, N_);
+    bitsX_.map() = ((matQ_.array() + real(1.)) / real(2.)).matrix().template cast<char>();
+}
+
+
+template class sqaod::CPUDenseGraphBatchAnnealer<float>;
+template class sqaod::CPUDenseGraphBatchAnnealer<double>;
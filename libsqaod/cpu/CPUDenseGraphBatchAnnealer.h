@@ -0,0 +1,91 @@
+/* -*- c++ -*- */
+#ifndef CPU_DENSEGRAPHBATCHANNEALER_H__
+#define CPU_DENSEGRAPHBATCHANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* Anneals a batch of independent dense graph problems of the same N, distributed over
+ * threads by problems.  Problems are held in stacked matrices, whose rows of a problem
+ * are contiguous, e.g. J of the problem p is J_.middleRows(p * N, N).
+ * Each problem owns a random number stream, thus results do not depend on the number
+ * of threads. */
+template<class real>
+class CPUDenseGraphBatchAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUDenseGraphBatchAnnealer();
+    ~CPUDenseGraphBatchAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *nProblems, SizeType *N, SizeType *m) const;
+
+    /* Ws is (nProblems * N, N), W of problems stacked. */
+    void setProblems(const Matrix &Ws, OptimizeMethod om);
+
+    void setNumTrotters(SizeType m);
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    /* (nProblems, m) */
+    const Matrix &get_E() const;
+
+    /* (nProblems * m, N), x of trotters of problems stacked. */
+    const BitMatrix &get_x() const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules as CPUDenseGraphAnnealer::anneal() does, and
+     * returns the best E (nProblems) and x (nProblems, N) of each problem. */
+    void anneal(Vector *E, BitMatrix *x,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+private:
+    void syncBits();
+
+    /* matH_ = h + q * J for each problem. */
+    void syncLocalFields(IdxType p);
+
+    void annealProblem(IdxType p, real G, real kT, SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    bool localFieldsValid_;
+
+    Random *random_;
+    unsigned long seed_;
+    int nThreads_;
+    SizeType nProblems_, N_, m_;
+    OptimizeMethod om_;
+    EigenMatrix h_;
+    EigenMatrix J_;
+    EigenRowVector c_;
+    EigenMatrix matQ_;
+    EigenMatrix matH_;
+    Matrix E_;
+    BitMatrix bitsX_;
+
+    CPUDenseGraphBatchAnnealer(const CPUDenseGraphBatchAnnealer &);
+    CPUDenseGraphBatchAnnealer &operator=(const CPUDenseGraphBatchAnnealer &);
+};
+
+}
+
+#endif
@@ -0,0 +1,262 @@
+#include "CPUDenseGraphMultiSpinAnnealer.h"
+#include "CPUFormulas.h"
+#include "Metropolis.h"
+#include <common/Common.h>
+#include <time.h>
+#include <cmath>
+
+namespace sqd = sqaod;
+
+
+template<class real>
+sqd::CPUDenseGraphMultiSpinAnnealer<real>::CPUDenseGraphMultiSpinAnnealer() {
+    N_ = 0;
+    m_ = -1;
+    annState_ = annNone;
+    localFieldsValid_ = false;
+    spins_ = NULL;
+}
+
+template<class real>
+sqd::CPUDenseGraphMultiSpinAnnealer<real>::~CPUDenseGraphMultiSpinAnnealer() {
+    delete [] spins_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::seed(unsigned long seed) {
+    random_.seed(seed);
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::getProblemSize(SizeType *N, SizeType *m) const {
+    *N = N_;
+    *m = m_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::setProblem(const Matrix &W, OptimizeMethod om) {
+    THROW_IF(!isSymmetric(W), "W is not symmetric.");
+    bool reshaped = (W.rows != N_);
+    N_ = W.rows;
+    h_.resize(1, N_);
+    J_.resize(N_, N_);
+    localFieldsValid_ = false;
+
+    Vector h(h_);
+    Matrix J(J_);
+    DGFuncs<real>::calculate_hJc(&h, &J, &c_, W);
+    om_ = om;
+    if (om_ == sqd::optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    /* spins follow the new N, and are randomized again. */
+    if (reshaped) {
+        if (annState_ & annNTrottersGiven)
+            setNumTrotters(m_);
+        annState_ &= ~annQSet;
+    }
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::setNumTrotters(SizeType m) {
+    THROW_IF(m <= 0, "m must be a positive integer.");
+    m_ = m;
+    delete [] spins_;
+    spins_ = new PackedBits[m_ * N_];
+    for (int r = 0; r < nReplicas; ++r) {
+        bitsX_[r].reserve(m_);
+        bitsQ_[r].reserve(m_);
+        E_[r].resize(m_);
+    }
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+}
+
+template<class real>
+const sqd::VectorType<real> &sqd::CPUDenseGraphMultiSpinAnnealer<real>::get_E(IdxType replica) const {
+    return E_[replica];
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUDenseGraphMultiSpinAnnealer<real>::get_x(IdxType replica) const {
+    return bitsX_[replica];
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::set_x(const Bits &x) {
+    for (int y = 0; y < IdxType(m_); ++y) {
+        for (int ix = 0; ix < IdxType(N_); ++ix)
+            spins_[y * N_ + ix] = x(ix) ? ~PackedBits(0) : PackedBits(0);
+    }
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::get_hJc(Vector *h, Matrix *J, real *c) const {
+    h->mapToRowVector() = h_;
+    J->map() = J_;
+    *c = c_;
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUDenseGraphMultiSpinAnnealer<real>::get_q(IdxType replica) const {
+    return bitsQ_[replica];
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::randomize_q() {
+    for (int idx = 0; idx < IdxType(N_ * m_); ++idx) {
+        PackedBits hi = random_.randInt32(), lo = random_.randInt32();
+        spins_[idx] = (hi << 32) | lo;
+    }
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    annState_ |= annRandSeedGiven;
+    if (!(annState_ & annNTrottersGiven))
+        setNumTrotters((N_) / 4);
+    annState_ |= annNTrottersGiven;
+    if (!(annState_ & annQSet))
+        randomize_q();
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::unpackTrotter(EigenMatrix *qy, IdxType y) const {
+    qy->resize(N_, nReplicas);
+    for (int x = 0; x < IdxType(N_); ++x) {
+        PackedBits s = spins_[y * N_ + x];
+        for (int r = 0; r < nReplicas; ++r)
+            (*qy)(x, r) = ((s >> r) & 1) ? real(1.) : real(-1.);
+    }
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::calculate_E() {
+    EigenMatrix qy;
+    for (int y = 0; y < IdxType(m_); ++y) {
+        unpackTrotter(&qy, y);
+        /* E_r = c + h * q_r + q_r^T * J * q_r, for 64 replicas at once. */
+        EigenMatrix Jq = J_ * qy;
+        EigenRowVector E = h_ * qy + qy.cwiseProduct(Jq).colwise().sum();
+        for (int r = 0; r < nReplicas; ++r) {
+            real v = E(r) + c_;
+            E_[r](y) = (om_ == sqd::optMaximize) ? - v : v;
+        }
+    }
+}
+
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::syncBits() {
+    for (int r = 0; r < nReplicas; ++r) {
+        bitsX_[r].clear();
+        bitsQ_[r].clear();
+        for (int y = 0; y < IdxType(m_); ++y) {
+            Bits x(N_), q(N_);
+            for (int ix = 0; ix < IdxType(N_); ++ix) {
+                char bit = (spins_[y * N_ + ix] >> r) & 1;
+                x(ix) = bit;
+                q(ix) = bit * 2 - 1;
+            }
+            bitsX_[r].pushBack(x);
+            bitsQ_[r].pushBack(q);
+        }
+    }
+}
+
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::syncLocalFields() {
+    matH_.resize(m_ * N_, nReplicas);
+    EigenMatrix qy;
+    for (int y = 0; y < IdxType(m_); ++y) {
+        unpackTrotter(&qy, y);
+        /* H_y = J * q_y + h^T */
+        matH_.block(y * N_, 0, N_, nReplicas) = J_ * qy;
+        matH_.block(y * N_, 0, N_, nReplicas).colwise() += h_.transpose();
+    }
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void sqd::CPUDenseGraphMultiSpinAnnealer<real>::annealOneStep(real G, real kT) {
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    real invKT = real(1.) / kT;
+    real dEdivKT[nReplicas];
+    EigenRowVector delta(nReplicas);
+
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = random_.randInt(N_);
+        int y = random_.randInt(m_);
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        PackedBits s = spins_[y * N_ + x];
+        PackedBits d0 = s ^ spins_[neibour0 * N_ + x];
+        PackedBits d1 = s ^ spins_[neibour1 * N_ + x];
+        const real *h = &matH_(y * N_ + x, 0);
+
+        /* qyx * (q(neibour0, x) + q(neibour1, x)) = 2 - 2 * (number of disagreements) */
+        for (int r = 0; r < nReplicas; ++r) {
+            real q = real(int((s >> r) & 1) * 2 - 1);
+            int nDisagreements = int((d0 >> r) & 1) + int((d1 >> r) & 1);
+            real dE = - twoDivM * q * h[r] - real(2 - 2 * nDisagreements) * coef;
+            dEdivKT[r] = dE * invKT;
+        }
+        /* 64 replicas are accepted at once, vectorized if CPU supports. */
+        PackedBits accepted = metropolisAccept(dEdivKT, random_, nReplicas);
+        if (accepted == 0)
+            continue;
+
+        spins_[y * N_ + x] = s ^ accepted;
+        /* diagonal elements of J_ are zero, thus matH_(y * N + x, r) stays unchanged.
+         * A few accepted replicas are updated in place, and more by a rank-1 update
+         * over rows of 64 replicas. */
+        const real *Jx = &J_(x, 0);
+        int nAccepted = 0;
+        int replicas[nReplicas];
+        real d[nReplicas];
+        for (PackedBits bits = accepted; bits != 0; bits &= bits - 1) {
+            int r = __builtin_ctzll(bits);
+            replicas[nAccepted] = r;
+            d[nAccepted] = real(-2.) * real(int((s >> r) & 1) * 2 - 1);
+            ++nAccepted;
+        }
+        if (nAccepted <= maxSparseUpdates) {
+            for (int j = 0; j < IdxType(N_); ++j) {
+                real *hj = &matH_(y * N_ + j, 0);
+                for (int idx = 0; idx < nAccepted; ++idx)
+                    hj[replicas[idx]] += Jx[j] * d[idx];
+            }
+        }
+        else {
+            for (int r = 0; r < nReplicas; ++r)
+                delta(r) = ((accepted >> r) & 1) ? real(-2.) * real(int((s >> r) & 1) * 2 - 1) : real(0.);
+            matH_.block(y * N_, 0, N_, nReplicas).noalias() += J_.row(x).transpose() * delta;
+        }
+    }
+}
+
+
+template class sqd::CPUDenseGraphMultiSpinAnnealer<float>;
+template class sqd::CPUDenseGraphMultiSpinAnnealer<double>;
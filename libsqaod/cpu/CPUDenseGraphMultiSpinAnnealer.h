@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+#ifndef CPU_DENSEGRAPHMULTISPINANNEALER_H__
+#define CPU_DENSEGRAPHMULTISPINANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* Anneals 64 independent replicas of a dense graph problem at once (multi-spin coding).
+ * The spin of replica r at (trotter y, x) is held in the bit r of a 64-bit word, and
+ * dE and Metropolis tests run over 64 replicas in a row, and local fields of accepted
+ * replicas are updated.  Local fields of a (y, x) are contiguous over replicas.
+ * Replicas share the sequence of proposed spins, and accept / reject independently. */
+template<class real>
+class CPUDenseGraphMultiSpinAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    enum {
+        nReplicas = 64,
+        /* up to this # of accepted replicas, fields are updated only for them. */
+        maxSparseUpdates = 16,
+    };
+
+    CPUDenseGraphMultiSpinAnnealer();
+    ~CPUDenseGraphMultiSpinAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N, SizeType *m) const;
+
+    void setProblem(const Matrix &W, OptimizeMethod om);
+
+    void setNumTrotters(SizeType m);
+
+    /* E and x of a replica, m elements as CPUDenseGraphAnnealer returns. */
+    const Vector &get_E(IdxType replica) const;
+
+    const BitsArray &get_x(IdxType replica) const;
+
+    /* sets x to all trotters of all replicas. */
+    void set_x(const Bits &x);
+
+    const BitsArray &get_q(IdxType replica) const;
+
+    void get_hJc(Vector *h, Matrix *J, real *c) const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+private:
+    void syncBits();
+
+    /* matH_(y * N + x, r) = h(x) + J.row(x).dot(q_r(y)), 64 replicas in a row. */
+    void syncLocalFields();
+
+    /* spins of a trotter, qy(x, r) = +1 / -1 */
+    void unpackTrotter(EigenMatrix *qy, IdxType y) const;
+
+    int annState_;
+    bool localFieldsValid_;
+
+    Random random_;
+    SizeType N_, m_;
+    OptimizeMethod om_;
+    Vector E_[nReplicas];
+    BitsArray bitsX_[nReplicas];
+    BitsArray bitsQ_[nReplicas];
+    PackedBits *spins_;
+    EigenMatrix matH_;
+    EigenRowVector h_;
+    EigenMatrix J_;
+    real c_;
+};
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+#include "CPUDenseGraphParallelTempering.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUDenseGraphParallelTempering<real>::CPUDenseGraphParallelTempering() {
+    N_ = nReplicas_ = 0;
+    annState_ = annNone;
+    fieldsValid_ = false;
+    randomPool_ = NULL;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+}
+
+template<class real>
+CPUDenseGraphParallelTempering<real>::~CPUDenseGraphParallelTempering() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::seed(unsigned long seed) {
+    seed_ = seed;
+    random_.seed(seed);
+    for (int r = 0; r < IdxType(nReplicas_); ++r)
+        randomPool_[r].seed(seed_, Random::streamId(r + 1, 0));
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::getProblemSize(SizeType *N, SizeType *nReplicas) const {
+    *N = N_;
+    *nReplicas = nReplicas_;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::setProblem(const Matrix &W, OptimizeMethod om) {
+    THROW_IF(!isSymmetric(W), "W is not symmetric.");
+    N_ = W.rows;
+    h_.resize(N_);
+    J_.resize(N_, N_);
+    Vector h(h_);
+    Matrix J(J_);
+    DGFuncs<real>::calculate_hJc(&h, &J, &c_, W);
+    om_ = om;
+    if (om_ == optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    annState_ &= ~annQSet;
+    fieldsValid_ = false;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::setTemperatures(const Vector &kT) {
+    ladder_.setTemperatures(kT);
+    if (kT.size != nReplicas_) {
+        delete [] randomPool_;
+        nReplicas_ = kT.size;
+        randomPool_ = new Random[nReplicas_];
+        if (annState_ & annRandSeedGiven)
+            seed(seed_);
+        annState_ &= ~annQSet;
+    }
+    fieldsValid_ = false;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    nThreads_ = nThreads;
+}
+
+template<class real>
+int CPUDenseGraphParallelTempering<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const VectorType<real> &CPUDenseGraphParallelTempering<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitsArray &CPUDenseGraphParallelTempering<real>::get_x() const {
+    return bitsX_;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::randomize_q() {
+    matQ_.resize(nReplicas_, N_);
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        for (int x = 0; x < IdxType(N_); ++x)
+            matQ_(r, x) = randomPool_[r].randInt(2) ? real(1.) : real(-1.);
+    }
+    Ebest_ = EigenRowVector::Constant(nReplicas_, FLT_MAX);
+    matQbest_.resize(nReplicas_, N_);
+    fieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::initAnneal() {
+    THROW_IF(nReplicas_ == 0, "Temperatures not given.");
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annQSet))
+        randomize_q();
+    if (!fieldsValid_)
+        syncFields();
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::finAnneal() {
+    /* energies accumulated by flips are replaced with exact ones. */
+    syncFields();
+    Vector h(h_), Ebest(Ebest_);
+    Matrix J(J_), qBest(matQbest_);
+    DGFuncs<real>::calculate_E(&Ebest, h, J, c_, qBest);
+    syncBits();
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::run(SizeType nExchanges, SizeType nSweeps) {
+    THROW_IF(nSweeps == 0, "nSweeps must be a positive integer.");
+    initAnneal();
+    for (SizeType loop = 0; loop < nExchanges; ++loop) {
+#pragma omp parallel num_threads(nThreads_)
+        {
+            SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+            for (int r = 0; r < IdxType(nReplicas_); ++r)
+                sweepReplica(r, nSweeps, sweepRandom);
+        }
+        ladder_.exchange(Ereplica_.data(), random_);
+    }
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::getBest(real *E, Bits *x) const {
+    THROW_IF(Ebest_.size() == 0, "Not annealed.");
+    IdxType rBest;
+    Ebest_.minCoeff(&rBest);
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    *E = sign * Ebest_(rBest);
+    EigenRowVector xBest = (matQbest_.row(rBest).array() + real(1.)) / real(2.);
+    *x = Bits(xBest.template cast<char>());
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::getSwapAcceptanceRates(Vector *rates) const {
+    ladder_.getAcceptanceRates(rates);
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::resetStatistics() {
+    ladder_.resetStatistics();
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::syncFields() {
+    matF_ = matQ_ * J_;
+    Ereplica_.resize(nReplicas_);
+    Vector h(h_), E(Ereplica_);
+    Matrix J(J_), q(matQ_);
+    DGFuncs<real>::calculate_E(&E, h, J, c_, q);
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        if (Ereplica_(r) < Ebest_(r)) {
+            Ebest_(r) = Ereplica_(r);
+            matQbest_.row(r) = matQ_.row(r);
+        }
+    }
+    fieldsValid_ = true;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::sweepReplica(IdxType r, SizeType nSweeps,
+                                                        SweepRandom<real> &sweepRandom) {
+    real kT = ladder_.kT(r);
+    real *q = &matQ_(r, 0);
+    const real *field = &matF_(r, 0);
+    real E = Ereplica_(r);
+
+    sweepRandom.draw(randomPool_[r], N_, nSweeps, sweepSequential, N_);
+    for (int loop = 0; loop < IdxType(N_ * nSweeps); ++loop) {
+        int x = sweepRandom.x(loop);
+        /* E = c + h * q + q^T * J * q, and J is symmetric. */
+        real dE = real(-2.) * q[x] * (h_(x) + real(2.) * field[x]);
+        if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+            q[x] = - q[x];
+            matF_.row(r) += (real(2.) * q[x]) * J_.row(x);
+            E += dE;
+        }
+        if ((x == IdxType(N_) - 1) && (E < Ebest_(r))) {
+            Ebest_(r) = E;
+            matQbest_.row(r) = matQ_.row(r);
+        }
+    }
+    Ereplica_(r) = E;
+}
+
+template<class real>
+void CPUDenseGraphParallelTempering<real>::syncBits() {
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    E_.resize(nReplicas_);
+    bitsX_.clear();
+    for (int iTemp = 0; iTemp < IdxType(nReplicas_); ++iTemp) {
+        IdxType r = ladder_.replicaAt(iTemp);
+        E_(iTemp) = sign * Ereplica_(r);
+        EigenRowVector x = (matQ_.row(r).array() + real(1.)) / real(2.);
+        bitsX_.pushBack(Bits(x.template cast<char>()));
+    }
+}
+
+
+template class sqaod::CPUDenseGraphParallelTempering<float>;
+template class sqaod::CPUDenseGraphParallelTempering<double>;
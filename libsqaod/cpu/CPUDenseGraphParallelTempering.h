@@ -0,0 +1,98 @@
+/* -*- c++ -*- */
+#ifndef CPU_DENSEGRAPHPARALLELTEMPERING_H__
+#define CPU_DENSEGRAPHPARALLELTEMPERING_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+#include <cpu/ReplicaExchange.h>
+
+namespace sqaod {
+
+/* Parallel tempering (replica exchange Monte Carlo) of a dense graph problem.
+ * Replicas run Metropolis sweeps of single spin flips at their temperatures by threads,
+ * and exchange temperatures with neighbours on the ladder after every nSweeps sweeps.
+ * Energies are E = c + h * q + q^T * J * q with (h, J, c) given by DGFuncs. */
+template<class real>
+class CPUDenseGraphParallelTempering {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUDenseGraphParallelTempering();
+    ~CPUDenseGraphParallelTempering();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N, SizeType *nReplicas) const;
+
+    void setProblem(const Matrix &W, OptimizeMethod om);
+
+    /* kT in ascending order, a replica per temperature. */
+    void setTemperatures(const Vector &kT);
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    /* E and x of replicas ordered by temperatures. */
+    const Vector &get_E() const;
+
+    const BitsArray &get_x() const;
+
+    void randomize_q();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    /* runs nExchanges rounds of nSweeps sweeps of all replicas and an exchange. */
+    void run(SizeType nExchanges, SizeType nSweeps);
+
+    /* the lowest E (the highest for optMaximize) and its x found after the last
+     * randomize_q(). */
+    void getBest(real *E, Bits *x) const;
+
+    /* accepted / attempted swaps between adjacent temperatures, nReplicas - 1 elements. */
+    void getSwapAcceptanceRates(Vector *rates) const;
+
+    void resetStatistics();
+
+private:
+    void syncBits();
+
+    void syncFields();
+
+    void sweepReplica(IdxType r, SizeType nSweeps, SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    bool fieldsValid_;
+
+    Random random_;
+    Random *randomPool_;
+    unsigned long seed_;
+    int nThreads_;
+    SizeType N_, nReplicas_;
+    OptimizeMethod om_;
+    EigenRowVector h_;
+    EigenMatrix J_;
+    real c_;
+    ReplicaExchange<real> ladder_;
+    /* spins and fields, matF_ = q * J, of replicas. */
+    EigenMatrix matQ_, matF_;
+    EigenRowVector Ereplica_;
+    /* the best of each replica. */
+    EigenRowVector Ebest_;
+    EigenMatrix matQbest_;
+    Vector E_;
+    BitsArray bitsX_;
+
+    CPUDenseGraphParallelTempering(const CPUDenseGraphParallelTempering &);
+    CPUDenseGraphParallelTempering &operator=(const CPUDenseGraphParallelTempering &);
+};
+
+}
+
+#endif
@@ -0,0 +1,276 @@
+#include "CPUDenseGraphPopulationAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+
+using namespace sqaod;
+
+
+template<class real>
+CPUDenseGraphPopulationAnnealer<real>::CPUDenseGraphPopulationAnnealer() {
+    N_ = 0;
+    nReplicas_ = 1024;
+    nSweeps_ = 1;
+    annState_ = annNone;
+    seed_ = 0;
+    beta_ = real(0.);
+    nFamilies_ = 0;
+    Ebest_ = FLT_MAX;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
+}
+
+template<class real>
+CPUDenseGraphPopulationAnnealer<real>::~CPUDenseGraphPopulationAnnealer() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::seed(unsigned long seed) {
+    random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx)
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::getProblemSize(SizeType *N, SizeType *nReplicas) const {
+    *N = N_;
+    *nReplicas = nReplicas_;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::setProblem(const Matrix &W, OptimizeMethod om) {
+    THROW_IF(!isSymmetric(W), "W is not symmetric.");
+    N_ = W.rows;
+    h_.resize(N_);
+    J_.resize(N_, N_);
+    Vector h(h_);
+    Matrix J(J_);
+    DGFuncs<real>::calculate_hJc(&h, &J, &c_, W);
+    om_ = om;
+    if (om_ == optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::setPopulationSize(SizeType nReplicas) {
+    THROW_IF(nReplicas == 0, "Population size must be a positive integer.");
+    nReplicas_ = nReplicas;
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::setNumSweeps(SizeType nSweeps) {
+    THROW_IF(nSweeps == 0, "nSweeps must be a positive integer.");
+    nSweeps_ = nSweeps;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int CPUDenseGraphPopulationAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const VectorType<real> &CPUDenseGraphPopulationAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const BitMatrix &CPUDenseGraphPopulationAnnealer<real>::get_x() const {
+    return bitsX_;
+}
+
+template<class real>
+SizeType CPUDenseGraphPopulationAnnealer<real>::getNumFamilies() const {
+    return nFamilies_;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::randomize_q() {
+    /* buffers are allocated here, and steps run without allocations. */
+    matQ_.resize(nReplicas_, N_);
+    matQNext_.resize(nReplicas_, N_);
+    matFNext_.resize(nReplicas_, N_);
+    EreplicaNext_.resize(nReplicas_);
+    cumWeights_.resize(nReplicas_);
+    parents_.resize(nReplicas_);
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        for (int x = 0; x < IdxType(N_); ++x)
+            matQ_(r, x) = random_.randInt(2) ? real(1.) : real(-1.);
+    }
+    beta_ = real(0.);
+    nFamilies_ = nReplicas_;
+    Ebest_ = FLT_MAX;
+    qBest_.resize(N_);
+    syncFields();
+    annState_ |= annQSet;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::calculate_E() {
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    E_.resize(nReplicas_);
+    E_.mapToRowVector() = sign * Ereplica_;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annQSet))
+        randomize_q();
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::finAnneal() {
+    /* energies accumulated by flips are replaced with exact ones. */
+    syncFields();
+    Vector h(h_), qBest(qBest_);
+    Matrix J(J_);
+    DGFuncs<real>::calculate_E(&Ebest_, h, J, c_, qBest);
+    calculate_E();
+    syncBits();
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::annealOneStep(real beta) {
+    THROW_IF(beta < beta_, "beta must not decrease.");
+    if (beta_ < beta)
+        resample(beta - beta_);
+    beta_ = beta;
+
+#pragma omp parallel num_threads(nThreads_)
+    {
+        Random &random = randomPool_[getThreadNum()];
+#pragma omp for schedule(static)
+        for (int r = 0; r < IdxType(nReplicas_); ++r)
+            sweepReplica(r, beta, random);
+    }
+    updateBest();
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::anneal(real *E, Bits *x, real betaFin, SizeType nSteps) {
+    THROW_IF(betaFin <= real(0.), "betaFin must be positive.");
+    THROW_IF(nSteps == 0, "nSteps must be a positive integer.");
+
+    initAnneal();
+    randomize_q();
+    for (SizeType step = 1; step <= nSteps; ++step)
+        annealOneStep(betaFin * real(step) / real(nSteps));
+    finAnneal();
+
+    real sign = (om_ == optMaximize) ? real(-1.) : real(1.);
+    *E = sign * Ebest_;
+    EigenRowVector xBest = (qBest_.array() + real(1.)) / real(2.);
+    *x = Bits(xBest.template cast<char>());
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::resample(real dBeta) {
+    /* systematic resampling, which keeps the population size and draws a single
+     * random number per step. */
+    real Emin = Ereplica_.minCoeff();
+    double sum = 0.;
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        sum += std::exp(- double(dBeta) * double(Ereplica_(r) - Emin));
+        cumWeights_[r] = sum;
+    }
+    double u = random_.random<double>();
+    IdxType parent = 0;
+    nFamilies_ = 0;
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        double target = (double(r) + u) / double(nReplicas_) * sum;
+        IdxType prev = parent;
+        while ((cumWeights_[parent] <= target) && (parent < IdxType(nReplicas_) - 1))
+            ++parent;
+        if ((r == 0) || (parent != prev))
+            ++nFamilies_;
+        parents_[r] = parent;
+    }
+
+#pragma omp parallel for num_threads(nThreads_) schedule(static)
+    for (int r = 0; r < IdxType(nReplicas_); ++r) {
+        matQNext_.row(r) = matQ_.row(parents_[r]);
+        matFNext_.row(r) = matF_.row(parents_[r]);
+        EreplicaNext_(r) = Ereplica_(parents_[r]);
+    }
+    matQ_.swap(matQNext_);
+    matF_.swap(matFNext_);
+    Ereplica_.swap(EreplicaNext_);
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::sweepReplica(IdxType r, real beta, Random &random) {
+    real *q = &matQ_(r, 0);
+    const real *field = &matF_(r, 0);
+    real E = Ereplica_(r);
+
+    for (SizeType sweep = 0; sweep < nSweeps_; ++sweep) {
+        for (int x = 0; x < IdxType(N_); ++x) {
+            /* E = c + h * q + q^T * J * q, and J is symmetric. */
+            real dE = real(-2.) * q[x] * (h_(x) + real(2.) * field[x]);
+            if ((dE <= real(0.)) || (std::exp(-beta * dE) > random.random<real>())) {
+                q[x] = - q[x];
+                matF_.row(r) += (real(2.) * q[x]) * J_.row(x);
+                E += dE;
+            }
+        }
+    }
+    Ereplica_(r) = E;
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::syncFields() {
+    /* energies of the whole population at once. */
+    matF_.noalias() = matQ_ * J_;
+    Ereplica_.resize(nReplicas_);
+    Vector h(h_), E(Ereplica_);
+    Matrix J(J_), q(matQ_);
+    DGFuncs<real>::calculate_E(&E, h, J, c_, q);
+    updateBest();
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::updateBest() {
+    IdxType rBest;
+    real E = Ereplica_.minCoeff(&rBest);
+    if (E < Ebest_) {
+        Ebest_ = E;
+        qBest_ = matQ_.row(rBest);
+    }
+}
+
+template<class real>
+void CPUDenseGraphPopulationAnnealer<real>::syncBits() {
+    bitsX_.resize(nReplicas_, N_);
+    bitsX_.map() = ((matQ_.array() + real(1.)) / real(2.)).matrix().template cast<char>();
+}
+
+
+template class sqaod::CPUDenseGraphPopulationAnnealer<float>;
+template class sqaod::CPUDenseGraphPopulationAnnealer<double>;
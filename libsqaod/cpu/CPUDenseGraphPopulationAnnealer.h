@@ -0,0 +1,110 @@
+/* -*- c++ -*- */
+#ifndef CPU_DENSEGRAPHPOPULATIONANNEALER_H__
+#define CPU_DENSEGRAPHPOPULATIONANNEALER_H__
+
+#include <vector>
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* Population annealing of a dense graph problem.
+ * A population of replicas starts from random spins, that is, at beta = 0.  Each step
+ * resamples replicas by Boltzmann weights, exp(-(beta - betaPrev) * E), to the next beta,
+ * and runs Metropolis sweeps at beta over replicas in parallel. */
+template<class real>
+class CPUDenseGraphPopulationAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUDenseGraphPopulationAnnealer();
+    ~CPUDenseGraphPopulationAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N, SizeType *nReplicas) const;
+
+    void setProblem(const Matrix &W, OptimizeMethod om);
+
+    void setPopulationSize(SizeType nReplicas);
+
+    /* Metropolis sweeps per step, 1 by default. */
+    void setNumSweeps(SizeType nSweeps);
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    const Vector &get_E() const;
+
+    /* x of replicas, (nReplicas, N). */
+    const BitMatrix &get_x() const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    /* resamples the population from the last beta to beta, and sweeps replicas at beta. */
+    void annealOneStep(real beta);
+
+    /* anneals with beta = betaFin * step / nSteps, step = 1, ..., nSteps, and returns
+     * the best E and x of the population through steps. */
+    void anneal(real *E, Bits *x, real betaFin, SizeType nSteps);
+
+    /* the number of distinct replicas chosen by the last resampling. */
+    SizeType getNumFamilies() const;
+
+private:
+    void syncBits();
+
+    void seedRandomPool();
+
+    void resample(real dBeta);
+
+    void sweepReplica(IdxType r, real beta, Random &random);
+
+    void syncFields();
+
+    void updateBest();
+
+    int annState_;
+
+    Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SizeType N_, nReplicas_, nSweeps_;
+    OptimizeMethod om_;
+    EigenRowVector h_;
+    EigenMatrix J_;
+    real c_;
+    real beta_;
+    /* spins, fields, q * J, and energies of replicas, and buffers they are resampled to,
+     * swapped after resampling.  Fields and energies are updated by flips. */
+    EigenMatrix matQ_, matQNext_;
+    EigenMatrix matF_, matFNext_;
+    EigenRowVector Ereplica_, EreplicaNext_;
+    /* cumulative weights and parents of replicas in resampling. */
+    std::vector<double> cumWeights_;
+    std::vector<IdxType> parents_;
+    SizeType nFamilies_;
+    real Ebest_;
+    EigenRowVector qBest_;
+    Vector E_;
+    BitMatrix bitsX_;
+
+    CPUDenseGraphPopulationAnnealer(const CPUDenseGraphPopulationAnnealer &);
+    CPUDenseGraphPopulationAnnealer &operator=(const CPUDenseGraphPopulationAnnealer &);
+};
+
+}
+
+#endif
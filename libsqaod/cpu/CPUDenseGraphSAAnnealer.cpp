@@ -0,0 +1,261 @@
+#include "CPUDenseGraphSAAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <cmath>
+#include <time.h>
+#include <float.h>
+#include <algorithm>
+
+namespace sqd = sqaod;
+
+
+template<class real>
+sqd::CPUDenseGraphSAAnnealer<real>::CPUDenseGraphSAAnnealer() {
+    N_ = m_ = 0;
+    annState_ = annNone;
+    sweepOrder_ = sweepSequential;
+    localFieldsValid_ = false;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
+}
+
+template<class real>
+sqd::CPUDenseGraphSAAnnealer<real>::~CPUDenseGraphSAAnnealer() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::seed(unsigned long seed) {
+    random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx)
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::getProblemSize(SizeType *N, SizeType *m) const {
+    *N = N_;
+    *m = m_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::setProblem(const Matrix &W, OptimizeMethod om) {
+    THROW_IF(!isSymmetric(W), "W is not symmetric.");
+    N_ = W.rows;
+    h_.resize(1, N_);
+    J_.resize(N_, N_);
+    localFieldsValid_ = false;
+
+    Vector h(h_);
+    Matrix J(J_);
+    DGFuncs<real>::calculate_hJc(&h, &J, &c_, W);
+    om_ = om;
+    if (om_ == sqd::optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+    if (annState_ & annNTrottersGiven)
+        setNumRestarts(m_);
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::setNumRestarts(SizeType m) {
+    THROW_IF(m == 0, "The number of restarts must be a positive integer.");
+    m_ = m;
+    bitsX_.reserve(m_);
+    bitsQ_.reserve(m_);
+    matQ_.resize(m_, N_);
+    E_.resize(m_);
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+    annState_ &= ~annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::setSweepOrder(SweepOrder order) {
+    switch (order) {
+    case sweepRandom:
+    case sweepPermutation:
+    case sweepBlocked:
+        sweepOrder_ = order;
+        break;
+    default:
+        sweepOrder_ = sweepSequential;
+        break;
+    }
+}
+
+template<class real>
+sqd::SweepOrder sqd::CPUDenseGraphSAAnnealer<real>::getSweepOrder() const {
+    return sweepOrder_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int sqd::CPUDenseGraphSAAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const sqd::VectorType<real> &sqd::CPUDenseGraphSAAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUDenseGraphSAAnnealer<real>::get_x() const {
+    return bitsX_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::set_x(const Bits &x) {
+    THROW_IF(x.size != N_, "Dimension of x does not match.");
+    EigenRowVector ex = x.mapToRowVector().template cast<real>();
+    matQ_.rowwise() = (ex.array() * 2 - 1).matrix();
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::get_hJc(Vector *h, Matrix *J, real *c) const {
+    h->mapToRowVector() = h_;
+    J->map() = J_;
+    *c = c_;
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUDenseGraphSAAnnealer<real>::get_q() const {
+    return bitsQ_;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::randomize_q() {
+    real *q = matQ_.data();
+    for (int idx = 0; idx < IdxType(N_ * m_); ++idx)
+        q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    if (!(annState_ & annNTrottersGiven))
+        setNumRestarts(std::max(N_ / 4, SizeType(1)));
+    if (!(annState_ & annQSet))
+        randomize_q();
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::calculate_E() {
+    DGFuncs<real>::calculate_E(&E_, h_, J_, c_, matQ_);
+    if (om_ == sqd::optMaximize)
+        E_.mapToRowVector() *= real(-1.);
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::syncBits() {
+    bitsX_.clear();
+    bitsQ_.clear();
+    for (int idx = 0; idx < IdxType(m_); ++idx) {
+        EigenBitMatrix eq = matQ_.transpose().col(idx).template cast<char>();
+        bitsQ_.pushBack(Bits(eq));
+        Bits x = Bits((eq.array() + 1) / 2);
+        bitsX_.pushBack(x);
+    }
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::syncLocalFields() {
+    matF_.noalias() = matQ_ * J_;
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::annealOneStep(real G, real kT) {
+    real T = std::max(G, kT);
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+#pragma omp parallel num_threads(nThreads_)
+    {
+        Random &random = randomPool_[getThreadNum()];
+        SweepRandom<real> sweepRandom;
+#pragma omp for schedule(static)
+        for (int y = 0; y < IdxType(m_); ++y)
+            annealRestart(y, T, random, sweepRandom);
+    }
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::annealRestart(int y, real kT, Random &random,
+                                                       SweepRandom<real> &sweepRandom) {
+    real *q = &matQ_(y, 0);
+    const real *field = &matF_(y, 0);
+
+    sweepRandom.draw(random, N_, 1, sweepOrder_, N_);
+    for (int loop = 0; loop < IdxType(N_); ++loop) {
+        int x = sweepRandom.x(loop);
+        /* E = c + h * q + q^T * J * q, and J is symmetric. */
+        real dE = real(-2.) * q[x] * (h_(x) + real(2.) * field[x]);
+        if ((dE <= real(0.)) || (std::exp(-dE / kT) > sweepRandom.uniform(loop))) {
+            q[x] = - q[x];
+            matF_.row(y) += (real(2.) * q[x]) * J_.row(x);
+        }
+    }
+}
+
+template<class real>
+void sqd::CPUDenseGraphSAAnnealer<real>::anneal(real *E, Bits *x,
+                                               real Ginit, real Gfin, real kT, real tau,
+                                               SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == sqd::optMaximize) ? real(-1.) : real(1.);
+    real Ebest = FLT_MAX;
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        for (real G = Ginit; Gfin < G; G *= tau)
+            annealOneStep(G, kT);
+        finAnneal();
+        for (int idx = 0; idx < IdxType(m_); ++idx) {
+            if (sign * E_(idx) < Ebest) {
+                Ebest = sign * E_(idx);
+                *x = bitsX_[idx];
+            }
+        }
+    }
+    *E = sign * Ebest;
+}
+
+
+template class sqd::CPUDenseGraphSAAnnealer<float>;
+template class sqd::CPUDenseGraphSAAnnealer<double>;
@@ -0,0 +1,101 @@
+/* -*- c++ -*- */
+#ifndef CPU_DENSEGRAPHSAANNEALER_H__
+#define CPU_DENSEGRAPHSAANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* classical simulated annealing of a dense graph problem with the interface of
+ * CPUDenseGraphAnnealer.  m independent restarts are annealed in parallel by
+ * Metropolis sweeps with local fields.  The temperature of a step is max(G, kT),
+ * so that schedules for the quantum annealers are read as temperature schedules. */
+template<class real>
+class CPUDenseGraphSAAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef MatrixType<real> Matrix;
+    typedef VectorType<real> Vector;
+
+public:
+    CPUDenseGraphSAAnnealer();
+    ~CPUDenseGraphSAAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N, SizeType *m) const;
+
+    void setProblem(const Matrix &W, OptimizeMethod om);
+
+    /* the number of restarts, N / 4 by default. */
+    void setNumRestarts(SizeType m);
+
+    /* sweepSequential (default), sweepRandom, sweepPermutation or sweepBlocked. */
+    void setSweepOrder(SweepOrder order);
+
+    SweepOrder getSweepOrder() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    const Vector &get_E() const;
+
+    const BitsArray &get_x() const;
+
+    void set_x(const Bits &x);
+
+    const BitsArray &get_q() const;
+
+    void get_hJc(Vector *h, Matrix *J, real *c) const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules, G = Ginit * tau^n while Gfin < G,
+     * and returns the best E and x found across repeats. */
+    void anneal(real *E, Bits *x,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+private:
+    void syncBits();
+
+    void seedRandomPool();
+
+    /* local fields, matF_ = matQ_ * J, updated only when a flip is accepted. */
+    void syncLocalFields();
+
+    void annealRestart(int y, real kT, Random &random, SweepRandom<real> &sweepRandom);
+
+    int annState_;
+    SweepOrder sweepOrder_;
+    bool localFieldsValid_;
+
+    Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SizeType N_, m_;
+    OptimizeMethod om_;
+    Vector E_;
+    BitsArray bitsX_;
+    BitsArray bitsQ_;
+    EigenMatrix matQ_;
+    EigenMatrix matF_;
+    EigenRowVector h_;
+    EigenMatrix J_;
+    real c_;
+};
+
+}
+
+#endif
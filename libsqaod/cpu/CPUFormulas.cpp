@@ -98,13 +98,107 @@ void DGFuncs<real>::batchSearch(real *E, PackedBitsArray *xList,
         else {
             Emin = eEbatch(idx);
             xList->clear();
-            xList->pushBack(idx);
+            xList->pushBack(xBegin + idx);
         }
     }
     *E = Emin;
 }
 
 
+namespace {
+
+/* visits (E, x) for gray codes, x = i ^ (i >> 1), of i in [xBegin, xEnd). */
+template<class real, class Visitor>
+void visitGrayCodes(Visitor &visit, const EigenMappedMatrixType<real> &eW,
+                    PackedBits xBegin, PackedBits xEnd) {
+    int N = eW.rows();
+    const PackedBits resyncInterval = 1024;
+    if (xEnd <= xBegin)
+        return;
+
+    /* initial x, W * x and E. */
+    PackedBits x = xBegin ^ (xBegin >> 1);
+    EigenMatrixType<real> ex(1, N);
+    createBitsSequence(ex.data(), N, x, x + 1);
+    EigenRowVectorType<real> eWx = ex * eW; /* W is symmetric. */
+    real Etmp = eWx.dot(ex.row(0));
+
+    for (PackedBits i = xBegin; ; ) {
+        visit(Etmp, x);
+
+        if (++i == xEnd)
+            break;
+        /* gray code of i differs from that of (i - 1) at the lowest set bit of i. */
+        int pos = 0;
+        while (((i >> pos) & 1) == 0)
+            ++pos;
+        x ^= PackedBits(1) << pos;
+        if ((i % resyncInterval) == 0) {
+            /* recalculate from scratch to bound accumulated rounding errors. */
+            createBitsSequence(ex.data(), N, x, x + 1);
+            eWx = ex * eW;
+            Etmp = eWx.dot(ex.row(0));
+            continue;
+        }
+        real dx = ((x >> pos) & 1) ? real(1.) : real(-1.);
+        Etmp += real(2.) * dx * eWx(pos) + eW(pos, pos);
+        eWx += dx * eW.row(pos);
+    }
+}
+
+/* pushes (E, x) to MinStates or TopKStates. */
+template<class real, class States>
+struct PushStatesVisitor {
+    States *states;
+
+    void operator()(real E, PackedBits x) {
+        states->push(E, x);
+    }
+};
+
+template<class real, class States>
+void pushBatchStates(States *states, const EigenMappedMatrixType<real> &eW,
+                     PackedBits xBegin, PackedBits xEnd) {
+    int nBatch = int(xEnd - xBegin);
+    int N = eW.rows();
+
+    EigenMatrixType<real> eBitsSeq(nBatch, N);
+    createBitsSequence(eBitsSeq.data(), N, xBegin, xEnd);
+    EigenMatrixType<real> eWx = eW * eBitsSeq.transpose();
+    EigenMatrixType<real> eEbatch = eWx.transpose().cwiseProduct(eBitsSeq).rowwise().sum();
+    for (int idx = 0; idx < nBatch; ++idx)
+        states->push(eEbatch(idx), xBegin + idx);
+}
+
+}
+
+template<class real>
+void DGFuncs<real>::batchSearch(MinStates<real, PackedBits> *minStates,
+                                const Matrix &W, PackedBits xBegin, PackedBits xEnd) {
+    pushBatchStates<real>(minStates, W.map(), xBegin, xEnd);
+}
+
+template<class real>
+void DGFuncs<real>::batchSearchGrayCode(MinStates<real, PackedBits> *minStates,
+                                        const Matrix &W, PackedBits xBegin, PackedBits xEnd) {
+    PushStatesVisitor<real, MinStates<real, PackedBits> > visit = { minStates };
+    visitGrayCodes<real>(visit, W.map(), xBegin, xEnd);
+}
+
+template<class real>
+void DGFuncs<real>::batchSearch(TopKStates<real, PackedBits> *topK,
+                                const Matrix &W, PackedBits xBegin, PackedBits xEnd) {
+    pushBatchStates<real>(topK, W.map(), xBegin, xEnd);
+}
+
+template<class real>
+void DGFuncs<real>::batchSearchGrayCode(TopKStates<real, PackedBits> *topK,
+                                        const Matrix &W, PackedBits xBegin, PackedBits xEnd) {
+    PushStatesVisitor<real, TopKStates<real, PackedBits> > visit = { topK };
+    visitGrayCodes<real>(visit, W.map(), xBegin, xEnd);
+}
+
+
 /* rbm */
 
 template<class real>
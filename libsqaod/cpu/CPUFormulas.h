@@ -2,6 +2,8 @@
 #define CPUFORMULAS_H__
 
 #include <common/Common.h>
+#include <cpu/TopKStates.h>
+#include <cpu/MinStates.h>
 
 
 #define THROW_IF(cond, msg) if (cond) throw std::runtime_error(msg);
@@ -11,6 +13,7 @@ namespace sqaod {
 template<class real>
 struct DGFuncs {
     typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
     typedef EigenMappedMatrixType<real> EigenMappedMatrix;
     typedef MatrixType<real> Matrix;
     typedef VectorType<real> Vector;
@@ -37,6 +40,26 @@ struct DGFuncs {
     static
     void batchSearch(real *E, PackedBitsArray *xList,
                      const Matrix &W, PackedBits xBegin, PackedBits xEnd);
+
+    /* MinStates versions store a bounded number of x at the minimum, and count all. */
+    static
+    void batchSearch(MinStates<real, PackedBits> *minStates,
+                     const Matrix &W, PackedBits xBegin, PackedBits xEnd);
+
+    /* enumerates gray codes, i ^ (i >> 1), for i in [xBegin, xEnd).
+     * One bit flips per step, and E is updated in O(N) from W * x. */
+    static
+    void batchSearchGrayCode(MinStates<real, PackedBits> *minStates,
+                             const Matrix &W, PackedBits xBegin, PackedBits xEnd);
+
+    /* top-K versions keep the K lowest states of [xBegin, xEnd) and those already in topK. */
+    static
+    void batchSearch(TopKStates<real, PackedBits> *topK,
+                     const Matrix &W, PackedBits xBegin, PackedBits xEnd);
+
+    static
+    void batchSearchGrayCode(TopKStates<real, PackedBits> *topK,
+                             const Matrix &W, PackedBits xBegin, PackedBits xEnd);
 };
     
 template<class real>
@@ -0,0 +1,423 @@
+#include "CPUSparseGraphAnnealer.h"
+#include "CPUFormulas.h"
+#include <common/Common.h>
+#include <time.h>
+#include <float.h>
+#include <vector>
+#include <algorithm>
+
+namespace sqd = sqaod;
+
+
+template<class real>
+sqd::CPUSparseGraphAnnealer<real>::CPUSparseGraphAnnealer() {
+    m_ = -1;
+    annState_ = annNone;
+    algo_ = algoLocalField;
+    sweepOrder_ = sweepRandom;
+    localFieldsValid_ = false;
+    seed_ = 0;
+    nThreads_ = getDefaultNumThreads();
+    randomPool_ = new Random[nThreads_];
+}
+
+template<class real>
+sqd::CPUSparseGraphAnnealer<real>::~CPUSparseGraphAnnealer() {
+    delete [] randomPool_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::seed(unsigned long seed) {
+    random_.seed(seed);
+    seed_ = seed;
+    seedRandomPool();
+    annState_ |= annRandSeedGiven;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::setRandomBackend(RandomBackend backend) {
+    random_.setBackend(backend);
+    random_.seed(seed_);
+    seedRandomPool();
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::seedRandomPool() {
+    for (int idx = 0; idx < nThreads_; ++idx) {
+        randomPool_[idx].setBackend(random_.getBackend());
+        randomPool_[idx].seed(seed_, Random::streamId(idx + 1, 0));
+    }
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::getProblemSize(SizeType *N, SizeType *m) const {
+    *N = N_;
+    *m = m_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::setProblem(SizeType N,
+                                                   const IdxVector &rowPtr, const IdxVector &colIdx,
+                                                   const Vector &values, OptimizeMethod om) {
+    THROW_IF(rowPtr.size != N + 1, "rowPtr should have N + 1 elements.");
+    THROW_IF(colIdx.size != values.size, "colIdx and values should have the same size.");
+    THROW_IF(rowPtr(N) != IdxType(values.size), "rowPtr(N) does not match the number of elements.");
+
+    typedef Eigen::Triplet<real, IdxType> Triplet;
+    std::vector<Triplet> triplets;
+    triplets.reserve(values.size);
+    for (IdxType row = 0; row < IdxType(N); ++row) {
+        THROW_IF(rowPtr(row + 1) < rowPtr(row), "rowPtr is not sorted.");
+        for (IdxType idx = rowPtr(row); idx < rowPtr(row + 1); ++idx) {
+            IdxType col = colIdx(idx);
+            THROW_IF((col < 0) || (IdxType(N) <= col), "column index out of range.");
+            triplets.push_back(Triplet(row, col, values(idx)));
+        }
+    }
+    EigenSparseMatrix W(N, N);
+    W.setFromTriplets(triplets.begin(), triplets.end());
+    EigenSparseMatrix Wt = W.transpose();
+    THROW_IF((W - Wt).norm() != real(0.), "W is not symmetric.");
+
+    N_ = N;
+    localFieldsValid_ = false;
+
+    /* same as DGFuncs<>::calculate_hJc(), without touching zero elements. */
+    h_ = real(0.5) * (W * EigenColumnVector::Ones(N_)).transpose();
+    real diagSum = W.diagonal().sum();
+    c_ = real(0.25) * (W.sum() + diagSum);
+    J_ = real(0.25) * W;
+    J_.prune([](IdxType row, IdxType col, real) { return row != col; });
+    J_.makeCompressed();
+
+    om_ = om;
+    if (om_ == sqd::optMaximize) {
+        h_ *= real(-1.);
+        J_ *= real(-1.);
+        c_ *= real(-1.);
+    }
+}
+
+template<class real>
+sqd::SizeType sqd::CPUSparseGraphAnnealer<real>::getNumNonZeros() const {
+    return J_.nonZeros();
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::setNumTrotters(SizeType m) {
+    m_ = m;
+    bitsX_.reserve(m_);
+    bitsQ_.reserve(m_);
+    matQ_.resize(m_, N_);;
+    E_.resize(m_);
+    localFieldsValid_ = false;
+    annState_ |= annNTrottersGiven;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::selectAlgorithm(Algorithm algo) {
+    switch (algo) {
+    case algoNaive:
+    case algoLocalField:
+    case algoColoring:
+        algo_ = algo;
+        break;
+    default:
+        algo_ = algoLocalField;
+        break;
+    }
+}
+
+template<class real>
+sqd::Algorithm sqd::CPUSparseGraphAnnealer<real>::getAlgorithm() const {
+    return algo_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::setSweepOrder(SweepOrder order) {
+    switch (order) {
+    case sweepSequential:
+    case sweepPermutation:
+    case sweepBlocked:
+        sweepOrder_ = order;
+        break;
+    default:
+        sweepOrder_ = sweepRandom;
+        break;
+    }
+}
+
+template<class real>
+sqd::SweepOrder sqd::CPUSparseGraphAnnealer<real>::getSweepOrder() const {
+    return sweepOrder_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::setNumThreads(int nThreads) {
+    THROW_IF(nThreads <= 0, "nThreads must be a positive integer.");
+    if (nThreads == nThreads_)
+        return;
+    delete [] randomPool_;
+    nThreads_ = nThreads;
+    randomPool_ = new Random[nThreads_];
+    seedRandomPool();
+}
+
+template<class real>
+int sqd::CPUSparseGraphAnnealer<real>::getNumThreads() const {
+    return nThreads_;
+}
+
+template<class real>
+const sqd::VectorType<real> &sqd::CPUSparseGraphAnnealer<real>::get_E() const {
+    return E_;
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUSparseGraphAnnealer<real>::get_x() const {
+    return bitsX_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::set_x(const Bits &x) {
+    EigenRowVector ex = x.mapToRowVector().cast<real>();
+    matQ_.rowwise() = (ex.array() * 2 - 1).matrix();
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::get_hJc(Vector *h,
+                                                IdxVector *rowPtr, IdxVector *colIdx, Vector *values,
+                                                real *c) const {
+    h->mapToRowVector() = h_;
+    const IdxType *outer = J_.outerIndexPtr();
+    for (IdxType row = 0; row < IdxType(N_) + 1; ++row)
+        (*rowPtr)(row) = outer[row];
+    const IdxType *inner = J_.innerIndexPtr();
+    const real *v = J_.valuePtr();
+    for (IdxType idx = 0; idx < IdxType(J_.nonZeros()); ++idx) {
+        (*colIdx)(idx) = inner[idx];
+        (*values)(idx) = v[idx];
+    }
+    *c = c_;
+}
+
+template<class real>
+const sqd::BitsArray &sqd::CPUSparseGraphAnnealer<real>::get_q() const {
+    return bitsQ_;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::randomize_q() {
+    real *q = matQ_.data();
+    for (int idx = 0; idx < IdxType(N_ * m_); ++idx)
+        q[idx] = random_.randInt(2) ? real(1.) : real(-1.);
+    localFieldsValid_ = false;
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::initAnneal() {
+    if (!(annState_ & annRandSeedGiven))
+        seed((unsigned long)time(NULL));
+    annState_ |= annRandSeedGiven;
+    /* N / 4 trotters, as the dense annealer does, is too many for large sparse problems. */
+    if (!(annState_ & annNTrottersGiven))
+        setNumTrotters(std::max(SizeType(2), std::min(N_ / 4, SizeType(64))));
+    annState_ |= annNTrottersGiven;
+    if (!(annState_ & annQSet))
+        randomize_q();
+    annState_ |= annQSet;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::finAnneal() {
+    syncBits();
+    calculate_E();
+}
+
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::calculate_E() {
+    /* J_ is symmetric, so E(y) = c + h * q(y)^T + q(y) * J * q(y)^T is calculated by
+     * (q * J) with O(m * nnz) operations. */
+    EigenMatrix matQJ = matQ_ * J_;
+    EigenColumnVector E = matQ_ * h_.transpose();
+    E += matQ_.cwiseProduct(matQJ).rowwise().sum();
+    E.array() += c_;
+    if (om_ == sqd::optMaximize)
+        E *= real(-1.);
+    E_.mapToColumnVector() = E;
+}
+
+
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::syncBits() {
+    bitsX_.clear();
+    bitsQ_.clear();
+    for (int idx = 0; idx < IdxType(m_); ++idx) {
+        EigenBitMatrix eq = matQ_.transpose().col(idx).template cast<char>();
+        bitsQ_.pushBack(Bits(eq));
+        Bits x = Bits((eq.array() + 1) / 2);
+        bitsX_.pushBack(x);
+    }
+}
+
+
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::annealOneStep(real G, real kT) {
+    switch (algo_) {
+    case algoNaive:
+        annealOneStepNaive(G, kT);
+        break;
+    case algoColoring:
+        annealOneStepColoring(G, kT);
+        break;
+    case algoLocalField:
+    default:
+        annealOneStepLocalField(G, kT);
+        break;
+    }
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::anneal(real *E, Bits *x,
+                                              real Ginit, real Gfin, real kT, real tau,
+                                              SizeType nRepeat) {
+    THROW_IF(!((real(0.) < tau) && (tau < real(1.))), "tau must be in (0, 1).");
+    THROW_IF(Gfin <= real(0.), "Gfin must be positive.");
+    THROW_IF(nRepeat == 0, "nRepeat must be a positive integer.");
+
+    real sign = (om_ == sqd::optMaximize) ? real(-1.) : real(1.);
+    real Ebest = FLT_MAX;
+    initAnneal();
+    for (SizeType loop = 0; loop < nRepeat; ++loop) {
+        randomize_q();
+        for (real G = Ginit; Gfin < G; G *= tau)
+            annealOneStep(G, kT);
+        finAnneal();
+        for (int idx = 0; idx < IdxType(m_); ++idx) {
+            if (sign * E_(idx) < Ebest) {
+                Ebest = sign * E_(idx);
+                *x = bitsX_[idx];
+            }
+        }
+    }
+    *E = sign * Ebest;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::annealOneStepNaive(real G, real kT) {
+    localFieldsValid_ = false;
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+
+    sweepRandom_.draw(random_, N_, m_, sweepOrder_, int(J_.nonZeros() / N_));
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = sweepRandom_.x(loop);
+        int y = sweepRandom_.y(loop);
+        real qyx = matQ_(y, x);
+        real sum = real(0.);
+        for (typename EigenSparseMatrix::InnerIterator it(J_, x); it; ++it)
+            sum += it.value() * matQ_(y, it.col());
+        real dE = - twoDivM * qyx * (h_(x) + sum);
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        dE -= qyx * (matQ_(neibour0, x) + matQ_(neibour1, x)) * coef;
+        real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        if (threshold > sweepRandom_.uniform(loop))
+            matQ_(y, x) = - qyx;
+    }
+}
+
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::syncLocalFields() {
+    /* J_ is symmetric, so (J * q^T)^T = q * J. */
+    matH_ = matQ_ * J_;
+    matH_.rowwise() += h_;
+    localFieldsValid_ = true;
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::annealOneStepLocalField(real G, real kT) {
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+
+    sweepRandom_.draw(random_, N_, m_, sweepOrder_, int(J_.nonZeros() / N_));
+    for (int loop = 0; loop < IdxType(N_ * m_); ++loop) {
+        int x = sweepRandom_.x(loop);
+        int y = sweepRandom_.y(loop);
+        real qyx = matQ_(y, x);
+        real dE = - twoDivM * qyx * matH_(y, x);
+        int neibour0 = (m_ + y - 1) % m_;
+        int neibour1 = (y + 1) % m_;
+        dE -= qyx * (matQ_(neibour0, x) + matQ_(neibour1, x)) * coef;
+        real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        if (threshold > sweepRandom_.uniform(loop)) {
+            matQ_(y, x) = - qyx;
+            /* J_ has no diagonal elements, thus matH_(y, x) stays unchanged. */
+            for (typename EigenSparseMatrix::InnerIterator it(J_, x); it; ++it)
+                matH_(y, it.col()) -= real(2.) * qyx * it.value();
+        }
+    }
+}
+
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::annealTrotter(int y, real G, real kT, Random &random) {
+    real twoDivM = real(2.) / real(m_);
+    real coef = std::log(std::tanh(G / kT / m_)) / kT;
+    int neibour0 = (m_ + y - 1) % m_;
+    int neibour1 = (y + 1) % m_;
+
+    for (int loop = 0; loop < IdxType(N_); ++loop) {
+        int x = (sweepOrder_ == sweepRandom) ? IdxType(random.randInt(N_)) : loop;
+        real qyx = matQ_(y, x);
+        real dE = - twoDivM * qyx * matH_(y, x);
+        dE -= qyx * (matQ_(neibour0, x) + matQ_(neibour1, x)) * coef;
+        real threshold = (dE < real(0.)) ? real(1.) : std::exp(-dE / kT);
+        if (threshold > random.random<real>()) {
+            matQ_(y, x) = - qyx;
+            for (typename EigenSparseMatrix::InnerIterator it(J_, x); it; ++it)
+                matH_(y, it.col()) -= real(2.) * qyx * it.value();
+        }
+    }
+}
+
+template<class real>
+void sqd::CPUSparseGraphAnnealer<real>::annealOneStepColoring(real G, real kT) {
+    if (!localFieldsValid_)
+        syncLocalFields();
+
+    /* trotters are colored as done in CPUDenseGraphAnnealer. */
+    int nEvenTrotters = (m_ % 2 == 0) ? IdxType(m_) : std::max(IdxType(m_) - 1, 1);
+    int phaseEnd[] = { nEvenTrotters, nEvenTrotters, IdxType(m_) };
+    int phaseBegin[] = { 0, 1, nEvenTrotters };
+    int phaseStride[] = { 2, 2, 1 };
+
+    for (int phase = 0; phase < 3; ++phase) {
+        if (phaseEnd[phase] <= phaseBegin[phase])
+            continue;
+        int nTrotters = (phaseEnd[phase] - phaseBegin[phase] + phaseStride[phase] - 1) / phaseStride[phase];
+#pragma omp parallel num_threads(nThreads_)
+        {
+            Random &random = randomPool_[getThreadNum()];
+#pragma omp for schedule(static)
+            for (int idx = 0; idx < nTrotters; ++idx) {
+                int y = phaseBegin[phase] + idx * phaseStride[phase];
+                annealTrotter(y, G, kT, random);
+            }
+        }
+    }
+}
+
+
+template class sqd::CPUSparseGraphAnnealer<float>;
+template class sqd::CPUSparseGraphAnnealer<double>;
@@ -0,0 +1,125 @@
+/* -*- c++ -*- */
+#ifndef CPU_SPARSEGRAPHANNEALER_H__
+#define CPU_SPARSEGRAPHANNEALER_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+#include <Eigen/Sparse>
+
+namespace sqaod {
+
+template<class real>
+class CPUSparseGraphAnnealer {
+
+    typedef EigenMatrixType<real> EigenMatrix;
+    typedef EigenRowVectorType<real> EigenRowVector;
+    typedef EigenColumnVectorType<real> EigenColumnVector;
+    /* row-major sparse matrix, CSR. */
+    typedef Eigen::SparseMatrix<real, Eigen::RowMajor, IdxType> EigenSparseMatrix;
+    typedef VectorType<real> Vector;
+    typedef VectorType<IdxType> IdxVector;
+
+public:
+    CPUSparseGraphAnnealer();
+    ~CPUSparseGraphAnnealer();
+
+    void seed(unsigned long seed);
+
+    void getProblemSize(SizeType *N, SizeType *m) const;
+
+    /* W is given in CSR format, W(row, colIdx[k]) = values[k] for
+     * rowPtr[row] <= k < rowPtr[row + 1].  W should be symmetric, and
+     * duplicated elements are summed up. */
+    void setProblem(SizeType N, const IdxVector &rowPtr, const IdxVector &colIdx,
+                    const Vector &values, OptimizeMethod om);
+
+    /* number of non-zero elements in J. */
+    SizeType getNumNonZeros() const;
+
+    void setNumTrotters(SizeType m);
+
+    void selectAlgorithm(Algorithm algo);
+
+    Algorithm getAlgorithm() const;
+
+    /* rngMT19937 (default), rngXoshiro256 or rngPhilox.  Random numbers are
+     * reseeded with the last seed given. */
+    void setRandomBackend(RandomBackend backend);
+
+    /* sweepRandom (default), sweepSequential, sweepPermutation or sweepBlocked.
+     * With algoColoring, orders other than sweepRandom visit spins of a trotter in order. */
+    void setSweepOrder(SweepOrder order);
+
+    SweepOrder getSweepOrder() const;
+
+    void setNumThreads(int nThreads);
+
+    int getNumThreads() const;
+
+    const Vector &get_E() const;
+
+    const BitsArray &get_x() const;
+
+    void set_x(const Bits &x);
+
+    const BitsArray &get_q() const;
+
+    /* J is returned in CSR format, each array should have getNumNonZeros() elements. */
+    void get_hJc(Vector *h, IdxVector *rowPtr, IdxVector *colIdx, Vector *values, real *c) const;
+
+    void randomize_q();
+
+    void calculate_E();
+
+    void initAnneal();
+
+    void finAnneal();
+
+    void annealOneStep(real G, real kT);
+
+    /* runs nRepeat annealing schedules, G = Ginit * tau^n while Gfin < G,
+     * and returns the best E and x found across repeats. */
+    void anneal(real *E, Bits *x,
+                real Ginit, real Gfin, real kT, real tau, SizeType nRepeat);
+
+private:
+    void syncBits();
+
+    /* dE is calculated from non-zero elements in a row of J, O(degree). */
+    void annealOneStepNaive(real G, real kT);
+
+    /* local fields, matH_(y, x) = h(x) + J.row(x).dot(matQ_.row(y)),
+     * are updated for the neighbours of x only when a flip is accepted. */
+    void syncLocalFields();
+    void annealOneStepLocalField(real G, real kT);
+
+    /* trotters of the same color are annealed in parallel. */
+    void annealOneStepColoring(real G, real kT);
+    void annealTrotter(int y, real G, real kT, Random &random);
+    void seedRandomPool();
+
+    int annState_;
+    Algorithm algo_;
+    SweepOrder sweepOrder_;
+    bool localFieldsValid_;
+
+    Random random_;
+    unsigned long seed_;
+    int nThreads_;
+    Random *randomPool_;
+    SweepRandom<real> sweepRandom_;
+    SizeType N_, m_;
+    OptimizeMethod om_;
+    Vector E_;
+    BitsArray bitsX_;
+    BitsArray bitsQ_;
+    EigenMatrix matQ_;
+    EigenMatrix matH_;
+    EigenRowVector h_;
+    EigenSparseMatrix J_;
+    real c_;
+};
+
+}
+
+#endif
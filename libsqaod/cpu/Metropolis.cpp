@@ -0,0 +1,249 @@
+#include "Metropolis.h"
+#include <cmath>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SQAOD_X86_DISPATCH
+#endif
+
+using namespace sqaod;
+
+namespace {
+
+/* exp(-maxDEdivKT) is below the resolution of uniforms, 2^-24 for float and 2^-53 for double,
+ * thus proposals with larger dE / kT are rejected without random numbers. */
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+float maxDEdivKT(float) {
+    return 17.f;
+}
+
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+double maxDEdivKT(double) {
+    return 37.;
+}
+
+/* exp(x) for x in [- maxDEdivKT, 0], x = k * ln2 + r, |r| <= ln2 / 2, exp(x) = 2^k * p(r)
+ * where p() is the Taylor series truncated below the precision of real. */
+
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+float expNeg(float x) {
+    /* rounded to nearest by truncation, as x <= 0. */
+    int ik = int(x * 1.44269504f - 0.5f);
+    float k = float(ik);
+    float r = x - k * 0.693359375f - k * -2.12194440e-4f;
+    float p = 1.f / 5040.f;
+    p = p * r + 1.f / 720.f;
+    p = p * r + 1.f / 120.f;
+    p = p * r + 1.f / 24.f;
+    p = p * r + 1.f / 6.f;
+    p = p * r + 0.5f;
+    p = p * r + 1.f;
+    p = p * r + 1.f;
+    int bits = (ik + 127) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+double expNeg(double x) {
+    int ik = int(x * 1.4426950408889634 - 0.5);
+    double k = double(ik);
+    double r = x - k * 0.693145751953125 - k * 1.42860682030941723212e-6;
+    double p = 1. / 479001600.;
+    p = p * r + 1. / 39916800.;
+    p = p * r + 1. / 3628800.;
+    p = p * r + 1. / 362880.;
+    p = p * r + 1. / 40320.;
+    p = p * r + 1. / 5040.;
+    p = p * r + 1. / 720.;
+    p = p * r + 1. / 120.;
+    p = p * r + 1. / 24.;
+    p = p * r + 1. / 6.;
+    p = p * r + 0.5;
+    p = p * r + 1.;
+    p = p * r + 1.;
+    long long bits = (long long)(ik + 1023) << 52;
+    double scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+/* flags are 0 or 1.  8 flags in a word are gathered to a byte by a multiplication. */
+inline
+PackedBits gatherBits(const unsigned char *flags, int n) {
+    PackedBits bits = 0;
+    int idx = 0;
+    for (; idx + 8 <= n; idx += 8) {
+        PackedBits word;
+        memcpy(&word, &flags[idx], sizeof(word));
+        bits |= ((word * 0x0102040810204080ULL) >> 56) << idx;
+    }
+    for (; idx < n; ++idx)
+        bits |= PackedBits(flags[idx]) << idx;
+    return bits;
+}
+
+
+/* kernels, compiled for each instruction set in the functions below.  Comparisons are
+ * if-converted to masks only without trapping math. */
+
+template<class real>
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+PackedBits acceptLanes(const real *dEdivKT, const real *u, int n) {
+    unsigned char accepted[64];
+#pragma omp simd
+    for (int idx = 0; idx < n; ++idx) {
+        real d = dEdivKT[idx];
+        real maxD = maxDEdivKT(d);
+        real dClamped = (d < real(0.)) ? real(0.) : d;
+        dClamped = (maxD < dClamped) ? maxD : dClamped;
+        accepted[idx] = (d < real(0.)) | ((d < maxD) & (u[idx] < expNeg(- dClamped)));
+    }
+    return gatherBits(accepted, n);
+}
+
+/* returns lanes which need random numbers, and lanes accepted by dE < 0 to *downhill. */
+template<class real>
+inline __attribute__((always_inline, optimize("no-trapping-math")))
+PackedBits undecidedLanes(const real *dEdivKT, int n, PackedBits *downhill) {
+    unsigned char undecided[64], negative[64];
+#pragma omp simd
+    for (int idx = 0; idx < n; ++idx) {
+        real d = dEdivKT[idx];
+        negative[idx] = (d < real(0.));
+        undecided[idx] = (real(0.) <= d) & (d < maxDEdivKT(d));
+    }
+    *downhill = gatherBits(negative, n);
+    return gatherBits(undecided, n);
+}
+
+#ifdef SQAOD_X86_DISPATCH
+
+template<class real> __attribute__((target("avx2,fma"), optimize("no-trapping-math")))
+PackedBits acceptAVX2(const real *dEdivKT, const real *u, int n) {
+    return acceptLanes(dEdivKT, u, n);
+}
+
+template<class real> __attribute__((target("avx2,fma"), optimize("no-trapping-math")))
+PackedBits undecidedAVX2(const real *dEdivKT, int n, PackedBits *downhill) {
+    return undecidedLanes(dEdivKT, n, downhill);
+}
+
+template<class real> __attribute__((target("avx512f,avx512dq,avx2,fma"), optimize("no-trapping-math")))
+PackedBits acceptAVX512(const real *dEdivKT, const real *u, int n) {
+    return acceptLanes(dEdivKT, u, n);
+}
+
+template<class real> __attribute__((target("avx512f,avx512dq,avx2,fma"), optimize("no-trapping-math")))
+PackedBits undecidedAVX512(const real *dEdivKT, int n, PackedBits *downhill) {
+    return undecidedLanes(dEdivKT, n, downhill);
+}
+
+#endif
+
+template<class real>
+PackedBits undecidedScalar(const real *dEdivKT, int n, PackedBits *downhill) {
+    PackedBits undecided = 0;
+    *downhill = 0;
+    for (int idx = 0; idx < n; ++idx) {
+        if (dEdivKT[idx] < real(0.))
+            *downhill |= PackedBits(1) << idx;
+        else if (dEdivKT[idx] < maxDEdivKT(dEdivKT[idx]))
+            undecided |= PackedBits(1) << idx;
+    }
+    return undecided;
+}
+
+
+SimdLevel detectSimdLevel() {
+#ifdef SQAOD_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        return simdAVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return simdAVX2;
+#endif
+    return simdScalar;
+}
+
+SimdLevel &simdLevel() {
+    static SimdLevel level = getSupportedSimdLevel();
+    return level;
+}
+
+}
+
+
+SimdLevel sqaod::getSupportedSimdLevel() {
+    static SimdLevel supported = detectSimdLevel();
+    return supported;
+}
+
+SimdLevel sqaod::getSimdLevel() {
+    return simdLevel();
+}
+
+void sqaod::setSimdLevel(SimdLevel level) {
+    simdLevel() = std::min(level, getSupportedSimdLevel());
+}
+
+
+template<class real>
+PackedBits sqaod::metropolisAcceptScalar(const real *dEdivKT, const real *u, int n) {
+    PackedBits accepted = 0;
+    for (int idx = 0; idx < n; ++idx) {
+        real d = dEdivKT[idx];
+        if ((d < real(0.)) || ((d < maxDEdivKT(d)) && (std::exp(- d) > u[idx])))
+            accepted |= PackedBits(1) << idx;
+    }
+    return accepted;
+}
+
+template<class real>
+PackedBits sqaod::metropolisAccept(const real *dEdivKT, const real *u, int n) {
+    switch (simdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+    case simdAVX512:
+        return acceptAVX512(dEdivKT, u, n);
+    case simdAVX2:
+        return acceptAVX2(dEdivKT, u, n);
+#endif
+    case simdScalar:
+    default:
+        return metropolisAcceptScalar(dEdivKT, u, n);
+    }
+}
+
+template<class real>
+PackedBits sqaod::metropolisAccept(const real *dEdivKT, Random &random, int n) {
+    PackedBits downhill, undecided;
+    switch (simdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+    case simdAVX512:
+        undecided = undecidedAVX512(dEdivKT, n, &downhill);
+        break;
+    case simdAVX2:
+        undecided = undecidedAVX2(dEdivKT, n, &downhill);
+        break;
+#endif
+    case simdScalar:
+    default:
+        undecided = undecidedScalar(dEdivKT, n, &downhill);
+        break;
+    }
+    if (undecided == 0)
+        return downhill;
+    real u[64];
+    random.random(u, n);
+    return metropolisAccept(dEdivKT, u, n);
+}
+
+
+template PackedBits sqaod::metropolisAccept(const float *dEdivKT, const float *u, int n);
+template PackedBits sqaod::metropolisAccept(const double *dEdivKT, const double *u, int n);
+template PackedBits sqaod::metropolisAccept(const float *dEdivKT, Random &random, int n);
+template PackedBits sqaod::metropolisAccept(const double *dEdivKT, Random &random, int n);
+template PackedBits sqaod::metropolisAcceptScalar(const float *dEdivKT, const float *u, int n);
+template PackedBits sqaod::metropolisAcceptScalar(const double *dEdivKT, const double *u, int n);
@@ -0,0 +1,43 @@
+/* -*- c++ -*- */
+#ifndef CPU_METROPOLIS_H__
+#define CPU_METROPOLIS_H__
+
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+enum SimdLevel {
+    simdScalar = 0,  /* std::exp(), reference */
+    simdAVX2 = 1,
+    simdAVX512 = 2,
+};
+
+/* the highest level supported by CPU, detected at the first call. */
+SimdLevel getSupportedSimdLevel();
+
+SimdLevel getSimdLevel();
+
+/* level is limited by getSupportedSimdLevel(). */
+void setSimdLevel(SimdLevel level);
+
+
+/* Metropolis acceptance for n (<= 64) independent proposals.
+ * Proposal i is accepted if dEdivKT[i] < 0 or exp(- dEdivKT[i]) > u[i], and
+ * returned as the i-th bit.  Proposals whose exp(- dEdivKT[i]) is below the resolution
+ * of u are rejected.  Vectorized paths evaluate exp() by a polynomial, whose relative
+ * error is below the resolution of u. */
+template<class real>
+PackedBits metropolisAccept(const real *dEdivKT, const real *u, int n);
+
+/* draws n uniforms from random only if any proposal is not decided by the sign of
+ * dE or by the resolution of uniforms. */
+template<class real>
+PackedBits metropolisAccept(const real *dEdivKT, Random &random, int n);
+
+template<class real>
+PackedBits metropolisAcceptScalar(const real *dEdivKT, const real *u, int n);
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+#ifndef CPU_MINSTATES_H__
+#define CPU_MINSTATES_H__
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <common/Common.h>
+
+namespace sqaod {
+
+/* states at the minimum energy of a search, stored in a buffer allocated by
+ * setCapacity().  All states at the minimum are counted, and the capacity smallest x
+ * are stored regardless of the order of push().  A full buffer is kept as a max-heap
+ * of x.  push() and merge() do not allocate.  capacity = 0 only counts states. */
+template<class real, class X>
+class MinStates {
+public:
+    MinStates() : capacity_(0) {
+        clear();
+    }
+
+    void setCapacity(SizeType capacity) {
+        capacity_ = capacity;
+        xList_.resize(capacity);
+        clear();
+    }
+
+    SizeType getCapacity() const {
+        return capacity_;
+    }
+
+    void clear() {
+        Emin_ = std::numeric_limits<real>::max();
+        nStates_ = 0;
+        nStored_ = 0;
+    }
+
+    real getEmin() const {
+        return Emin_;
+    }
+
+    /* # states at Emin, including those not stored. */
+    unsigned long long getNumStates() const {
+        return nStates_;
+    }
+
+    /* # stored states, in no particular order. */
+    SizeType size() const {
+        return nStored_;
+    }
+
+    const X &operator[](SizeType idx) const {
+        return xList_[idx];
+    }
+
+    void push(real E, const X &x) {
+        if (Emin_ < E)
+            return;
+        if (E < Emin_) {
+            Emin_ = E;
+            nStates_ = 0;
+            nStored_ = 0;
+        }
+        store(x);
+        ++nStates_;
+    }
+
+    void merge(const MinStates &other) {
+        if (Emin_ < other.Emin_)
+            return;
+        if (other.Emin_ < Emin_) {
+            Emin_ = other.Emin_;
+            nStates_ = 0;
+            nStored_ = 0;
+        }
+        for (SizeType idx = 0; idx < other.nStored_; ++idx)
+            store(other.xList_[idx]);
+        nStates_ += other.nStates_;
+    }
+
+private:
+    void store(const X &x) {
+        if (nStored_ < capacity_) {
+            xList_[nStored_++] = x;
+            if (nStored_ == capacity_)
+                std::make_heap(xList_.begin(), xList_.end());
+        }
+        else if ((capacity_ != 0) && (x < xList_.front())) {
+            std::pop_heap(xList_.begin(), xList_.end());
+            xList_.back() = x;
+            std::push_heap(xList_.begin(), xList_.end());
+        }
+    }
+
+    real Emin_;
+    unsigned long long nStates_;
+    SizeType nStored_, capacity_;
+    std::vector<X> xList_;
+};
+
+}
+
+#endif
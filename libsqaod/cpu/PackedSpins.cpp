@@ -0,0 +1,125 @@
+#include "PackedSpins.h"
+#include <cmath>
+#include <string.h>
+#include <algorithm>
+
+using namespace sqaod;
+
+
+PackedSpinMatrix::PackedSpinMatrix() {
+    rows_ = nSpins_ = nWords_ = 0;
+    words_ = NULL;
+}
+
+PackedSpinMatrix::~PackedSpinMatrix() {
+    delete [] words_;
+}
+
+void PackedSpinMatrix::resize(SizeType rows, SizeType nSpins) {
+    if ((rows == rows_) && (nSpins == nSpins_))
+        return;
+    delete [] words_;
+    rows_ = rows;
+    nSpins_ = nSpins;
+    nWords_ = (nSpins + 63) / 64;
+    words_ = new PackedBits[rows_ * nWords_];
+    memset(words_, 0, sizeof(PackedBits) * rows_ * nWords_);
+}
+
+template<class real>
+void PackedSpinMatrix::pack(const EigenMatrixType<real> &q) {
+    resize(q.rows(), q.cols());
+    for (IdxType r = 0; r < IdxType(rows_); ++r) {
+        PackedBits *words = row(r);
+        memset(words, 0, sizeof(PackedBits) * nWords_);
+        for (IdxType x = 0; x < IdxType(nSpins_); ++x) {
+            if (real(0.) < q(r, x))
+                words[x >> 6] |= PackedBits(1) << (x & 63);
+        }
+    }
+}
+
+template<class real>
+void PackedSpinMatrix::unpack(EigenMatrixType<real> *q) const {
+    q->resize(rows_, nSpins_);
+    for (IdxType r = 0; r < IdxType(rows_); ++r) {
+        for (IdxType x = 0; x < IdxType(nSpins_); ++x)
+            (*q)(r, x) = get(r, x) ? real(1.) : real(-1.);
+    }
+}
+
+
+BitPlaneCouplings::BitPlaneCouplings() {
+    rows_ = nWords_ = 0;
+    nPlanes_ = 0;
+    sign_ = NULL;
+    planes_ = NULL;
+    planeCount_ = NULL;
+}
+
+BitPlaneCouplings::~BitPlaneCouplings() {
+    release();
+}
+
+void BitPlaneCouplings::release() {
+    delete [] sign_;
+    delete [] planes_;
+    delete [] planeCount_;
+    sign_ = NULL;
+    planes_ = NULL;
+    planeCount_ = NULL;
+    nPlanes_ = 0;
+}
+
+template<class real>
+bool BitPlaneCouplings::set(const EigenMatrixType<real> &J, int maxPlanes) {
+    release();
+
+    long maxAbs = 0;
+    for (IdxType r = 0; r < IdxType(J.rows()); ++r) {
+        for (IdxType c = 0; c < IdxType(J.cols()); ++c) {
+            real v = J(r, c);
+            if ((v != std::floor(v)) || (real(1L << maxPlanes) <= std::fabs(v)))
+                return false;
+            maxAbs = std::max(maxAbs, (long)std::fabs(v));
+        }
+    }
+    int nPlanes = 1;
+    while ((1L << nPlanes) <= maxAbs)
+        ++nPlanes;
+
+    rows_ = J.rows();
+    nWords_ = (J.cols() + 63) / 64;
+    nPlanes_ = nPlanes;
+    sign_ = new PackedBits[rows_ * nWords_];
+    planes_ = new PackedBits[nPlanes_ * rows_ * nWords_];
+    planeCount_ = new long[nPlanes_ * rows_];
+    memset(sign_, 0, sizeof(PackedBits) * rows_ * nWords_);
+    memset(planes_, 0, sizeof(PackedBits) * nPlanes_ * rows_ * nWords_);
+    memset(planeCount_, 0, sizeof(long) * nPlanes_ * rows_);
+
+    for (IdxType r = 0; r < IdxType(rows_); ++r) {
+        for (IdxType c = 0; c < IdxType(J.cols()); ++c) {
+            real v = J(r, c);
+            long mag = (long)std::fabs(v);
+            PackedBits bit = PackedBits(1) << (c & 63);
+            if (v < real(0.))
+                sign_[r * nWords_ + (c >> 6)] |= bit;
+            for (int k = 0; k < nPlanes_; ++k) {
+                if ((mag >> k) & 1) {
+                    planes_[(k * rows_ + r) * nWords_ + (c >> 6)] |= bit;
+                    ++planeCount_[k * rows_ + r];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+template void PackedSpinMatrix::pack<float>(const EigenMatrixType<float> &q);
+template void PackedSpinMatrix::pack<double>(const EigenMatrixType<double> &q);
+template void PackedSpinMatrix::unpack<float>(EigenMatrixType<float> *q) const;
+template void PackedSpinMatrix::unpack<double>(EigenMatrixType<double> *q) const;
+template bool BitPlaneCouplings::set<float>(const EigenMatrixType<float> &J, int maxPlanes);
+template bool BitPlaneCouplings::set<double>(const EigenMatrixType<double> &J, int maxPlanes);
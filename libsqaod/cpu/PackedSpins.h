@@ -0,0 +1,114 @@
+/* -*- c++ -*- */
+#ifndef CPU_PACKEDSPINS_H__
+#define CPU_PACKEDSPINS_H__
+
+#include <common/Common.h>
+
+namespace sqaod {
+
+inline
+int popcount(PackedBits v) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(v);
+#else
+    return __builtin_popcountll(v);
+#endif
+}
+
+
+/* spins of m trotters, q = +1 / -1, packed to bits, 1 / 0, in 64-bit words.
+ * Each row is padded by zeros to a word boundary. */
+class PackedSpinMatrix {
+public:
+    PackedSpinMatrix();
+    ~PackedSpinMatrix();
+
+    void resize(SizeType rows, SizeType nSpins);
+
+    SizeType getNumWords() const {
+        return nWords_;
+    }
+
+    PackedBits *row(IdxType r) {
+        return &words_[r * nWords_];
+    }
+    const PackedBits *row(IdxType r) const {
+        return &words_[r * nWords_];
+    }
+
+    bool get(IdxType r, IdxType x) const {
+        return (row(r)[x >> 6] >> (x & 63)) & 1;
+    }
+
+    void flip(IdxType r, IdxType x) {
+        row(r)[x >> 6] ^= PackedBits(1) << (x & 63);
+    }
+
+    /* returns the number of spins in row r1 and r2 which differ from (r0, x), 0, 1 or 2. */
+    int countDisagreements(IdxType r0, IdxType r1, IdxType r2, IdxType x) const {
+        IdxType w = x >> 6, b = x & 63;
+        PackedBits v = row(r0)[w];
+        return int(((v ^ row(r1)[w]) >> b) & 1) + int(((v ^ row(r2)[w]) >> b) & 1);
+    }
+
+    template<class real>
+    void pack(const EigenMatrixType<real> &q);
+
+    template<class real>
+    void unpack(EigenMatrixType<real> *q) const;
+
+private:
+    PackedSpinMatrix(const PackedSpinMatrix &);
+    PackedSpinMatrix &operator=(const PackedSpinMatrix &);
+
+    SizeType rows_, nSpins_, nWords_;
+    PackedBits *words_;
+};
+
+
+/* integral couplings split into a sign bit and magnitude bit-planes,
+ * J(r, c) = (-1)^sign(r, c) * sum_k 2^k * plane_k(r, c), rows packed in 64-bit words. */
+class BitPlaneCouplings {
+public:
+    BitPlaneCouplings();
+    ~BitPlaneCouplings();
+
+    /* returns false, and releases planes, if J is not integral or |J| >= 2^maxPlanes. */
+    template<class real>
+    bool set(const EigenMatrixType<real> &J, int maxPlanes = 16);
+
+    bool isSet() const {
+        return nPlanes_ != 0;
+    }
+
+    /* sum_c J(r, c) * q(c), q given by packed spins. */
+    long dot(IdxType r, const PackedBits *q) const {
+        const PackedBits *sign = &sign_[r * nWords_];
+        long sum = 0;
+        for (int k = 0; k < nPlanes_; ++k) {
+            const PackedBits *plane = &planes_[(k * rows_ + r) * nWords_];
+            /* J(r, c) * q(c) is positive where sign ^ q is 1. */
+            long nPositive = 0;
+            for (IdxType w = 0; w < IdxType(nWords_); ++w)
+                nPositive += popcount(plane[w] & (sign[w] ^ q[w]));
+            sum += (2 * nPositive - planeCount_[k * rows_ + r]) << k;
+        }
+        return sum;
+    }
+
+private:
+    BitPlaneCouplings(const BitPlaneCouplings &);
+    BitPlaneCouplings &operator=(const BitPlaneCouplings &);
+
+    void release();
+
+    SizeType rows_, nWords_;
+    int nPlanes_;
+    PackedBits *sign_;
+    PackedBits *planes_;
+    long *planeCount_;
+};
+
+}
+
+#endif
@@ -1,4 +1,155 @@
 #include "Random.h"
+#include "Metropolis.h"
+#include <string.h>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SQAOD_X86_DISPATCH
+#endif
+
+
+namespace {
+
+/* kernels of block generators and bulk conversions, compiled for each instruction set
+ * in the functions below, and dispatched by sqaod::getSimdLevel() as metropolisAccept(). */
+
+template<int nLanes>
+inline __attribute__((always_inline))
+void xoshiroLanes(unsigned long long *out, int nOut, unsigned long long xs[4][nLanes]) {
+    unsigned long long s0[nLanes], s1[nLanes], s2[nLanes], s3[nLanes];
+    memcpy(s0, xs[0], sizeof(s0));
+    memcpy(s1, xs[1], sizeof(s1));
+    memcpy(s2, xs[2], sizeof(s2));
+    memcpy(s3, xs[3], sizeof(s3));
+    for (int idx = 0; idx < nOut; idx += nLanes) {
+#pragma omp simd
+        for (int lane = 0; lane < nLanes; ++lane) {
+            unsigned long long v = s1[lane] + (s1[lane] << 2);
+            v = (v << 7) | (v >> 57);
+            out[idx + lane] = v + (v << 3);
+            unsigned long long t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = (s3[lane] << 45) | (s3[lane] >> 19);
+        }
+    }
+    memcpy(xs[0], s0, sizeof(s0));
+    memcpy(xs[1], s1, sizeof(s1));
+    memcpy(xs[2], s2, sizeof(s2));
+    memcpy(xs[3], s3, sizeof(s3));
+}
+
+/* counters from ctr to ctr + nOut / 4, 4 words per counter. */
+template<int nLanes>
+inline __attribute__((always_inline))
+void philoxLanes(unsigned int *out, int nOut, unsigned long long ctr,
+                 unsigned long long stream, unsigned long long seed) {
+    const unsigned int M0 = 0xd2511f53U, M1 = 0xcd9e8d57U;
+    const unsigned int W0 = 0x9e3779b9U, W1 = 0xbb67ae85U;
+    for (int idx = 0; idx < nOut; idx += 4 * nLanes) {
+        unsigned int c0[nLanes], c1[nLanes], c2[nLanes], c3[nLanes];
+        for (int lane = 0; lane < nLanes; ++lane) {
+            unsigned long long c = ctr + lane;
+            c0[lane] = (unsigned int)c;
+            c1[lane] = (unsigned int)(c >> 32);
+            c2[lane] = (unsigned int)stream;
+            c3[lane] = (unsigned int)(stream >> 32);
+        }
+        ctr += nLanes;
+        unsigned int k0 = (unsigned int)seed, k1 = (unsigned int)(seed >> 32);
+        for (int round = 0; round < 10; ++round) {
+#pragma omp simd
+            for (int lane = 0; lane < nLanes; ++lane) {
+                unsigned long long p0 = (unsigned long long)M0 * c0[lane];
+                unsigned long long p1 = (unsigned long long)M1 * c2[lane];
+                unsigned int n0 = (unsigned int)(p1 >> 32) ^ c1[lane] ^ k0;
+                unsigned int n2 = (unsigned int)(p0 >> 32) ^ c3[lane] ^ k1;
+                c1[lane] = (unsigned int)p1;
+                c3[lane] = (unsigned int)p0;
+                c0[lane] = n0;
+                c2[lane] = n2;
+            }
+            k0 += W0;
+            k1 += W1;
+        }
+        for (int lane = 0; lane < nLanes; ++lane) {
+            out[idx + lane * 4] = c0[lane];
+            out[idx + lane * 4 + 1] = c1[lane];
+            out[idx + lane * 4 + 2] = c2[lane];
+            out[idx + lane * 4 + 3] = c3[lane];
+        }
+    }
+}
+
+/* the same numbers as randomf32() and randomf64().  Words are shifted to fit int,
+ * which converts to real in SIMD units without 64-bit conversions (AVX2). */
+inline __attribute__((always_inline))
+void uniformsF32(float *v, const unsigned int *src, int n) {
+#pragma omp simd
+    for (int idx = 0; idx < n; ++idx)
+        v[idx] = int(src[idx] >> 8) * float(1./16777216.);
+}
+
+inline __attribute__((always_inline))
+void uniformsF64(double *v, const unsigned int *src, int n) {
+#pragma omp simd
+    for (int idx = 0; idx < n; ++idx) {
+        double a = int(src[idx * 2] >> 5), b = int(src[idx * 2 + 1] >> 6);
+        v[idx] = (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+    }
+}
+
+#ifdef SQAOD_X86_DISPATCH
+
+template<int nLanes> __attribute__((target("avx2")))
+void xoshiroAVX2(unsigned long long *out, int nOut, unsigned long long xs[4][nLanes]) {
+    xoshiroLanes(out, nOut, xs);
+}
+
+template<int nLanes> __attribute__((target("avx512f,avx2")))
+void xoshiroAVX512(unsigned long long *out, int nOut, unsigned long long xs[4][nLanes]) {
+    xoshiroLanes(out, nOut, xs);
+}
+
+template<int nLanes> __attribute__((target("avx2")))
+void philoxAVX2(unsigned int *out, int nOut, unsigned long long ctr,
+                unsigned long long stream, unsigned long long seed) {
+    philoxLanes<nLanes>(out, nOut, ctr, stream, seed);
+}
+
+template<int nLanes> __attribute__((target("avx512f,avx2")))
+void philoxAVX512(unsigned int *out, int nOut, unsigned long long ctr,
+                  unsigned long long stream, unsigned long long seed) {
+    philoxLanes<nLanes>(out, nOut, ctr, stream, seed);
+}
+
+__attribute__((target("avx2")))
+void uniformsF32AVX2(float *v, const unsigned int *src, int n) {
+    uniformsF32(v, src, n);
+}
+
+__attribute__((target("avx512f,avx2")))
+void uniformsF32AVX512(float *v, const unsigned int *src, int n) {
+    uniformsF32(v, src, n);
+}
+
+__attribute__((target("avx2")))
+void uniformsF64AVX2(double *v, const unsigned int *src, int n) {
+    uniformsF64(v, src, n);
+}
+
+__attribute__((target("avx512f,avx2")))
+void uniformsF64AVX512(double *v, const unsigned int *src, int n) {
+    uniformsF64(v, src, n);
+}
+
+#endif
+
+}
+
 
 
 /* 
@@ -58,7 +209,49 @@ void Random::seed() {
 #define LOWER_MASK 0x7fffffffUL /* least significant r bits */
 
 /* initializes mt[N] with a seed */
-void Random::seed(unsigned long s)
+void Random::seed(unsigned long s) {
+    seed(s, 0);
+}
+
+void Random::seed(unsigned long s, unsigned long long stream) {
+    seed_ = s;
+    stream_ = stream;
+    pos_ = len_ = 0;
+    switch (backend_) {
+    case rngXoshiro256: {
+        /* lane 0 is initialized by splitmix64, and lane (l + 1) is
+         * 2^128 numbers ahead of lane l. */
+        unsigned long long x = (unsigned long long)s ^ (stream * 0xd1342543de82ef95ULL);
+        for (int idx = 0; idx < 4; ++idx)
+            xs_[idx][0] = splitmix64(&x);
+        for (int lane = 1; lane < nXoshiroLanes; ++lane) {
+            unsigned long long st[4];
+            for (int idx = 0; idx < 4; ++idx)
+                st[idx] = xs_[idx][lane - 1];
+            xoshiroJump(st);
+            for (int idx = 0; idx < 4; ++idx)
+                xs_[idx][lane] = st[idx];
+        }
+        break;
+    }
+    case rngPhilox:
+        ctr_ = 0;
+        break;
+    case rngMT19937:
+    default:
+        if (stream == 0) {
+            mtSeed(s);
+        }
+        else {
+            unsigned long key[] = { s, (unsigned long)(stream & 0xffffffffUL),
+                                    (unsigned long)(stream >> 32) };
+            initByArray(key, 3);
+        }
+        break;
+    }
+}
+
+void Random::mtSeed(unsigned long s)
 {
     mt[0]= s & 0xffffffffUL;
     for (mti=1; mti<N; mti++) {
@@ -73,14 +266,11 @@ void Random::seed(unsigned long s)
     }
 }
 
-/* initialize by an array with array-length */
-/* init_key is the array for initializing keys */
-/* key_length is its length */
-/* slight change for C++, 2004/2/26 */
 void Random::initByArray(unsigned long init_key[], int key_length)
 {
     int i, j, k;
-    seed(19650218UL);
+    mtSeed(19650218UL);
+    pos_ = len_ = 0;
     i=1; j=0;
     k = (N>key_length ? N : key_length);
     for (; k; k--) {
@@ -103,60 +293,224 @@ void Random::initByArray(unsigned long init_key[], int key_length)
 }
 
 /* generates a random number on [0,0xffffffff]-interval */
-unsigned long Random::randInt32(void) {
+void Random::refill() {
+    switch (backend_) {
+    case rngXoshiro256:
+        refillXoshiro256();
+        break;
+    case rngPhilox:
+        refillPhilox();
+        break;
+    case rngMT19937:
+    default:
+        refillMT19937();
+        break;
+    }
+    pos_ = 0;
+}
+
+void Random::refillMT19937() {
     unsigned long y;
     static unsigned long mag01[2]={0x0UL, MATRIX_A};
     /* mag01[x] = x * MATRIX_A  for x=0,1 */
 
-    if (mti >= N) { /* generate N words at one time */
-        int kk;
+    /* generate N words at one time */
+    int kk;
 
-        if (mti == N+1)   /* if init_genrand() has not been called, */
-            seed(5489UL); /* a default initial seed is used */
+    if (mti == N+1)   /* if init_genrand() has not been called, */
+        mtSeed(5489UL); /* a default initial seed is used */
 
-        for (kk=0;kk<N-M;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-            mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        for (;kk<N-1;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-            mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
-        mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    for (kk=0;kk<N-M;kk++) {
+        y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
+        mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    }
+    for (;kk<N-1;kk++) {
+        y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
+        mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    }
+    y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
+    mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
+
+    for (kk = 0; kk < N; ++kk) {
+        y = mt[kk];
+        /* Tempering */
+        y ^= (y >> 11);
+        y ^= (y << 7) & 0x9d2c5680UL;
+        y ^= (y << 15) & 0xefc60000UL;
+        y ^= (y >> 18);
+        buf_[kk] = (unsigned int)y;
+    }
+    mti = N;
+    len_ = N;
+}
 
-        mti = 0;
+
+/* xoshiro256** by David Blackman and Sebastiano Vigna, http://prng.di.unimi.it/
+ * Lanes are stored as structure of arrays so that the lane loop is vectorized.
+ * Multiplications by 5 and 9 are written as shifts and adds, which SIMD units
+ * without 64-bit multipliers (AVX2) handle. */
+
+void Random::refillXoshiro256() {
+    unsigned long long out[bufSize / 2];
+    switch (sqaod::getSimdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+    case sqaod::simdAVX512:
+        xoshiroAVX512(out, bufSize / 2, xs_);
+        break;
+    case sqaod::simdAVX2:
+        xoshiroAVX2(out, bufSize / 2, xs_);
+        break;
+#endif
+    case sqaod::simdScalar:
+    default:
+        xoshiroLanes(out, bufSize / 2, xs_);
+        break;
     }
-  
-    y = mt[mti++];
+    memcpy(buf_, out, sizeof(out));
+    len_ = bufSize;
+}
 
-    /* Tempering */
-    y ^= (y >> 11);
-    y ^= (y << 7) & 0x9d2c5680UL;
-    y ^= (y << 15) & 0xefc60000UL;
-    y ^= (y >> 18);
+void Random::xoshiroJump(unsigned long long st[4]) {
+    static const unsigned long long JUMP[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    unsigned long long s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= st[0];
+                s1 ^= st[1];
+                s2 ^= st[2];
+                s3 ^= st[3];
+            }
+            unsigned long long t = st[1] << 17;
+            st[2] ^= st[0];
+            st[3] ^= st[1];
+            st[1] ^= st[2];
+            st[0] ^= st[3];
+            st[2] ^= t;
+            st[3] = (st[3] << 45) | (st[3] >> 19);
+        }
+    }
+    st[0] = s0;
+    st[1] = s1;
+    st[2] = s2;
+    st[3] = s3;
+}
 
-    return y;
+unsigned long long Random::splitmix64(unsigned long long *x) {
+    unsigned long long z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
 }
 
-unsigned long Random::randInt(int high) {
-    return randInt32() % high;
+
+/* Philox4x32-10, J. K. Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC'11.
+ * counter = (ctr_, stream_), key = seed_.  A block of nPhiloxLanes counters is
+ * processed at once. */
+
+void Random::refillPhilox() {
+    switch (sqaod::getSimdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+    case sqaod::simdAVX512:
+        philoxAVX512<nPhiloxLanes>(buf_, bufSize, ctr_, stream_, seed_);
+        break;
+    case sqaod::simdAVX2:
+        philoxAVX2<nPhiloxLanes>(buf_, bufSize, ctr_, stream_, seed_);
+        break;
+#endif
+    case sqaod::simdScalar:
+    default:
+        philoxLanes<nPhiloxLanes>(buf_, bufSize, ctr_, stream_, seed_);
+        break;
+    }
+    ctr_ += bufSize / 4;
+    len_ = bufSize;
 }
 
 
-/* generates a random number on [0,1)-real-interval */
-float Random::randomf32(void)
-{
-    return randInt32()* float(1./4294967296.); 
-    /* divided by 2^32 */
+void Random::randInt32(unsigned int *v, int n) {
+    while (0 < n) {
+        if (pos_ == len_)
+            refill();
+        int nCopy = std::min(n, len_ - pos_);
+        memcpy(v, &buf_[pos_], sizeof(unsigned int) * nCopy);
+        pos_ += nCopy;
+        v += nCopy;
+        n -= nCopy;
+    }
 }
 
+void Random::randInt(int *v, int n, int high) {
+    while (0 < n) {
+        if (pos_ == len_)
+            refill();
+        int nCopy = std::min(n, len_ - pos_);
+        const unsigned int *src = &buf_[pos_];
+#pragma omp simd
+        for (int idx = 0; idx < nCopy; ++idx)
+            v[idx] = int(src[idx] % (unsigned int)high);
+        pos_ += nCopy;
+        v += nCopy;
+        n -= nCopy;
+    }
+}
 
-/* generates a random number on [0,1) with 53-bit resolution*/
-double Random::randomf64(void)  { 
-    unsigned long a=randInt32()>>5, b=randInt32()>>6; 
-    return(a*67108864.0+b)*(1.0/9007199254740992.0); 
-} 
+void Random::random(float *v, int n) {
+    while (0 < n) {
+        if (pos_ == len_)
+            refill();
+        int nCopy = std::min(n, len_ - pos_);
+        switch (sqaod::getSimdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+        case sqaod::simdAVX512:
+            uniformsF32AVX512(v, &buf_[pos_], nCopy);
+            break;
+        case sqaod::simdAVX2:
+            uniformsF32AVX2(v, &buf_[pos_], nCopy);
+            break;
+#endif
+        case sqaod::simdScalar:
+        default:
+            uniformsF32(v, &buf_[pos_], nCopy);
+            break;
+        }
+        pos_ += nCopy;
+        v += nCopy;
+        n -= nCopy;
+    }
+}
+
+void Random::random(double *v, int n) {
+    /* two words per number, as randomf64().  A number across refills is drawn by randomf64(). */
+    while (0 < n) {
+        if (len_ - pos_ < 2) {
+            *v++ = randomf64();
+            --n;
+            continue;
+        }
+        int nCopy = std::min(n, (len_ - pos_) / 2);
+        switch (sqaod::getSimdLevel()) {
+#ifdef SQAOD_X86_DISPATCH
+        case sqaod::simdAVX512:
+            uniformsF64AVX512(v, &buf_[pos_], nCopy);
+            break;
+        case sqaod::simdAVX2:
+            uniformsF64AVX2(v, &buf_[pos_], nCopy);
+            break;
+#endif
+        case sqaod::simdScalar:
+        default:
+            uniformsF64(v, &buf_[pos_], nCopy);
+            break;
+        }
+        pos_ += nCopy * 2;
+        v += nCopy;
+        n -= nCopy;
+    }
+}
 
 #if 0
 
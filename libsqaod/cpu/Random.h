@@ -2,16 +2,53 @@
 #ifndef CPU_RANDOM_H__
 #define CPU_RANDOM_H__
 
+#include <stddef.h>
+#include <algorithm>
+#include <common/Common.h>
+
+enum RandomBackend {
+    rngMT19937 = 0,     /* Mersenne Twister, default */
+    rngXoshiro256 = 1,  /* xoshiro256**, 8 lanes are generated at once */
+    rngPhilox = 2,      /* Philox4x32-10, counter-based */
+};
+
+/* Random numbers are generated by blocks into an internal buffer, and
+ * scalar draws read from it.  Bulk draws convert a block at once.  Block generators
+ * and bulk conversions are vectorized at sqaod::getSimdLevel(), with the same numbers. */
 class Random {
 public:
     Random() {
+        backend_ = rngMT19937;
         mti = N + 1;
+        pos_ = len_ = 0;
+        seed_ = 5489UL;
+        stream_ = 0;
+        ctr_ = 0;
+    }
+
+    /* takes effect at the next seed(). */
+    void setBackend(RandomBackend backend) {
+        backend_ = backend;
+    }
+
+    RandomBackend getBackend() const {
+        return backend_;
     }
 
     void seed();
 
     void seed(unsigned long s);
 
+    /* seeds a stream identified by (s, stream).  Philox streams are independent by
+     * construction.  Others derive their states from (s, stream) by hashing. */
+    void seed(unsigned long s, unsigned long long stream);
+
+    /* stream id for a (thread, trotter) pair, used with seed(s, stream).  seed(s) gives
+     * stream 0, thus pools drawn along with such a generator start at thread 1. */
+    static unsigned long long streamId(unsigned int thread, unsigned int trotter) {
+        return ((unsigned long long)trotter << 32) | thread;
+    }
+
     void initByArray(unsigned long initKey[], int keyLength);
 
     unsigned long randInt32();
@@ -24,19 +61,70 @@ public:
 
     template<class real>
     real random();
-    
-    
+
+    /* bulk draws, n numbers at once. */
+    void randInt32(unsigned int *v, int n);
+
+    void randInt(int *v, int n, int N);
+
+    void random(float *v, int n);
+
+    void random(double *v, int n);
+
 private:
     enum {
         N = 624,
-        M = 397
+        M = 397,
+        bufSize = 1024,
+        nXoshiroLanes = 8,
+        nPhiloxLanes = 16,
     };
 
+    void refill();
+    void mtSeed(unsigned long s);
+    void refillMT19937();
+    void refillXoshiro256();
+    void refillPhilox();
+    static void xoshiroJump(unsigned long long st[4]);
+    static unsigned long long splitmix64(unsigned long long *x);
+
+    RandomBackend backend_;
+    unsigned int buf_[bufSize];
+    int pos_, len_;
+    unsigned long seed_;
+    unsigned long long stream_;
+
     unsigned long mt[N]; /* the array for the state vector  */
     int mti; /* mti==N+1 means mt[N] is not initialized */
+
+    unsigned long long xs_[4][nXoshiroLanes];
+    unsigned long long ctr_;
 };
 
 
+inline
+unsigned long Random::randInt32() {
+    if (pos_ == len_)
+        refill();
+    return buf_[pos_++];
+}
+
+inline
+unsigned long Random::randInt(int high) {
+    return randInt32() % high;
+}
+
+inline
+float Random::randomf32() {
+    /* 24 bits, as float has 24-bit mantissa.  randInt32() / 2^32 may be rounded to 1. */
+    return int(randInt32() >> 8) * float(1./16777216.);
+}
+
+inline
+double Random::randomf64() {
+    unsigned long a = randInt32() >> 5, b = randInt32() >> 6;
+    return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+}
 
 template<> inline
 float Random::random<float>() {
@@ -48,4 +136,104 @@ double Random::random<double>() {
 }
 
 
+/* (x, y) and uniform random numbers for a sweep of N * m flips,
+ * drawn in bulk before the sweep. */
+template<class real>
+class SweepRandom {
+public:
+    SweepRandom() : capacity_(0), x_(NULL), y_(NULL), u_(NULL) { }
+
+    ~SweepRandom() {
+        release();
+    }
+
+    /* x in [0, N), y in [0, m) in the given order, uniform in [0, 1).
+     * rowSize is the number of elements read per x, such as a row of J, and
+     * sweepBlocked chooses tiles of x whose rows fit in tileBytes. */
+    void draw(Random &random, int N, int m, sqaod::SweepOrder order, int rowSize) {
+        int nProposals = N * m;
+        if (capacity_ < nProposals) {
+            release();
+            capacity_ = nProposals;
+            x_ = new int[capacity_];
+            y_ = new int[capacity_];
+            u_ = new real[capacity_];
+        }
+        switch (order) {
+        case sqaod::sweepSequential:
+        case sqaod::sweepPermutation: {
+            int idx = 0;
+            for (int y = 0; y < m; ++y) {
+                for (int x = 0; x < N; ++x, ++idx) {
+                    x_[idx] = x;
+                    y_[idx] = y;
+                }
+            }
+            if (order == sqaod::sweepPermutation) {
+                for (idx = nProposals - 1; 0 < idx; --idx) {
+                    int other = random.randInt(idx + 1);
+                    std::swap(x_[idx], x_[other]);
+                    std::swap(y_[idx], y_[other]);
+                }
+            }
+            break;
+        }
+        case sqaod::sweepBlocked: {
+            int tileSize = std::max(1, int(tileBytes / (sizeof(real) * std::max(rowSize, 1))));
+            int idx = 0;
+            for (int xBegin = 0; xBegin < N; xBegin += tileSize) {
+                int xEnd = std::min(xBegin + tileSize, N);
+                for (int y = 0; y < m; ++y) {
+                    for (int x = xBegin; x < xEnd; ++x, ++idx) {
+                        x_[idx] = x;
+                        y_[idx] = y;
+                    }
+                }
+            }
+            break;
+        }
+        case sqaod::sweepRandom:
+        default:
+            random.randInt(x_, nProposals, N);
+            random.randInt(y_, nProposals, m);
+            break;
+        }
+        random.random(u_, nProposals);
+    }
+
+    int x(int idx) const {
+        return x_[idx];
+    }
+
+    int y(int idx) const {
+        return y_[idx];
+    }
+
+    real uniform(int idx) const {
+        return u_[idx];
+    }
+
+private:
+    enum {
+        tileBytes = 256 * 1024, /* L2 */
+    };
+
+    SweepRandom(const SweepRandom &);
+    SweepRandom &operator=(const SweepRandom &);
+
+    void release() {
+        delete [] x_;
+        delete [] y_;
+        delete [] u_;
+        x_ = y_ = NULL;
+        u_ = NULL;
+        capacity_ = 0;
+    }
+
+    int capacity_;
+    int *x_, *y_;
+    real *u_;
+};
+
+
 #endif
@@ -0,0 +1,65 @@
+#include "ReplicaExchange.h"
+#include "CPUFormulas.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace sqaod;
+
+
+template<class real>
+ReplicaExchange<real>::ReplicaExchange() {
+    parity_ = 0;
+}
+
+template<class real>
+void ReplicaExchange<real>::setTemperatures(const Vector &kT) {
+    THROW_IF(kT.size == 0, "No temperature given.");
+    for (int idx = 0; idx < IdxType(kT.size); ++idx) {
+        THROW_IF(kT(idx) <= real(0.), "kT must be positive.");
+        THROW_IF((0 < idx) && (kT(idx) <= kT(idx - 1)), "kT must be in ascending order.");
+    }
+    kT_.assign(kT.data, kT.data + kT.size);
+    replicaAt_.resize(kT.size);
+    tempOf_.resize(kT.size);
+    for (int idx = 0; idx < IdxType(kT.size); ++idx)
+        replicaAt_[idx] = tempOf_[idx] = idx;
+    parity_ = 0;
+    resetStatistics();
+}
+
+template<class real>
+void ReplicaExchange<real>::exchange(const real *E, Random &random) {
+    int nTemps = IdxType(kT_.size());
+    for (int iTemp = parity_; iTemp + 1 < nTemps; iTemp += 2) {
+        IdxType r0 = replicaAt_[iTemp], r1 = replicaAt_[iTemp + 1];
+        real delta = (real(1.) / kT_[iTemp] - real(1.) / kT_[iTemp + 1]) * (E[r0] - E[r1]);
+        ++nAttempts_[iTemp];
+        if ((delta >= real(0.)) || (std::exp(delta) > random.random<real>())) {
+            replicaAt_[iTemp] = r1;
+            replicaAt_[iTemp + 1] = r0;
+            tempOf_[r0] = iTemp + 1;
+            tempOf_[r1] = iTemp;
+            ++nAccepted_[iTemp];
+        }
+    }
+    parity_ ^= 1;
+}
+
+template<class real>
+void ReplicaExchange<real>::getAcceptanceRates(Vector *rates) const {
+    int nPairs = std::max(IdxType(kT_.size()) - 1, 0);
+    rates->resize(nPairs);
+    for (int idx = 0; idx < nPairs; ++idx)
+        (*rates)(idx) = (nAttempts_[idx] == 0) ?
+                real(0.) : real(double(nAccepted_[idx]) / double(nAttempts_[idx]));
+}
+
+template<class real>
+void ReplicaExchange<real>::resetStatistics() {
+    nAttempts_.assign(kT_.size(), 0);
+    nAccepted_.assign(kT_.size(), 0);
+}
+
+
+template class sqaod::ReplicaExchange<float>;
+template class sqaod::ReplicaExchange<double>;
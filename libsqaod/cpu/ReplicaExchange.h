@@ -0,0 +1,55 @@
+/* -*- c++ -*- */
+#ifndef CPU_REPLICAEXCHANGE_H__
+#define CPU_REPLICAEXCHANGE_H__
+
+#include <vector>
+#include <common/Common.h>
+#include <cpu/Random.h>
+
+namespace sqaod {
+
+/* temperature ladder of parallel tempering.  Replicas stay in place, and temperatures
+ * are exchanged between replicas at adjacent temperatures.  Swaps of pairs (i, i + 1)
+ * are accepted with min(1, exp((1 / kT(i) - 1 / kT(i + 1)) * (E(i) - E(i + 1)))), and
+ * counted per pair to tune the ladder. */
+template<class real>
+class ReplicaExchange {
+    typedef VectorType<real> Vector;
+public:
+    ReplicaExchange();
+
+    /* kT in ascending order, a replica per temperature. */
+    void setTemperatures(const Vector &kT);
+
+    SizeType getNumReplicas() const {
+        return SizeType(kT_.size());
+    }
+
+    /* the replica at the iTemp-th temperature. */
+    IdxType replicaAt(IdxType iTemp) const {
+        return replicaAt_[iTemp];
+    }
+
+    real kT(IdxType replica) const {
+        return kT_[tempOf_[replica]];
+    }
+
+    /* tries swaps of even pairs, (0, 1), (2, 3), ..., and odd pairs alternately.
+     * E is indexed by replicas. */
+    void exchange(const real *E, Random &random);
+
+    /* accepted / attempted swaps of pairs (i, i + 1), nReplicas - 1 elements. */
+    void getAcceptanceRates(Vector *rates) const;
+
+    void resetStatistics();
+
+private:
+    std::vector<real> kT_;
+    std::vector<IdxType> replicaAt_, tempOf_;
+    std::vector<unsigned long long> nAttempts_, nAccepted_;
+    int parity_;
+};
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* -*- c++ -*- */
+#ifndef CPU_TOPKSTATES_H__
+#define CPU_TOPKSTATES_H__
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <common/Common.h>
+
+namespace sqaod {
+
+/* K lowest-energy states of a search in a bounded max-heap.  States are ordered by
+ * (E, x), thus ties at the K-th energy are broken by smaller x, and merged results do
+ * not depend on how the search space is split among searchers.  The heap is allocated
+ * by setCapacity(), and push() does not allocate. */
+template<class real, class X>
+class TopKStates {
+public:
+    struct State {
+        real E;
+        X x;
+
+        bool operator<(const State &rhs) const {
+            return (E < rhs.E) || ((E == rhs.E) && (x < rhs.x));
+        }
+    };
+
+    TopKStates() : K_(1) { }
+
+    void setCapacity(SizeType K) {
+        K_ = std::max(K, SizeType(1));
+        heap_.clear();
+        heap_.reserve(K_);
+    }
+
+    SizeType getCapacity() const {
+        return K_;
+    }
+
+    SizeType size() const {
+        return SizeType(heap_.size());
+    }
+
+    void clear() {
+        heap_.clear();
+    }
+
+    /* states of E above the threshold are never kept. */
+    real threshold() const {
+        return (heap_.size() < K_) ? std::numeric_limits<real>::max() : heap_.front().E;
+    }
+
+    void push(real E, const X &x) {
+        State state = { E, x };
+        if (heap_.size() < K_) {
+            heap_.push_back(state);
+            std::push_heap(heap_.begin(), heap_.end());
+        }
+        else if (state < heap_.front()) {
+            std::pop_heap(heap_.begin(), heap_.end());
+            heap_.back() = state;
+            std::push_heap(heap_.begin(), heap_.end());
+        }
+    }
+
+    void merge(const TopKStates &other) {
+        for (size_t idx = 0; idx < other.heap_.size(); ++idx)
+            push(other.heap_[idx].E, other.heap_[idx].x);
+    }
+
+    /* states in ascending order of (E, x). */
+    void getSorted(std::vector<State> *states) const {
+        *states = heap_;
+        std::sort(states->begin(), states->end());
+    }
+
+private:
+    SizeType K_;
+    std::vector<State> heap_;
+};
+
+}
+
+#endif
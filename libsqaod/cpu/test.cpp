@@ -0,0 +1,167 @@
+#include <cpu/Metropolis.h>
+#include <cpu/Random.h>
+#include <common/BitsSubSpace.h>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+using namespace sqaod;
+
+namespace {
+
+int nFailures = 0;
+
+void check(bool cond, const char *caption, SimdLevel level, int n) {
+    if (!cond) {
+        std::cerr << "FAILED: " << caption << ", simd level = " << level << ", n = " << n << std::endl;
+        ++nFailures;
+    }
+}
+
+}
+
+
+/* dE / kT around 0 and maxDEdivKT (17 for float, 37 for double), and u apart from
+ * exp(- dE / kT) by more than the error of vectorized exp(). */
+template<class real>
+void createProposals(real *dEdivKT, real *u, Random &random) {
+    const real maxD = (sizeof(real) == sizeof(float)) ? real(17.) : real(37.);
+    const real edges[] = { real(-1.), real(0.), maxD * real(0.999), maxD, maxD * real(1.001) };
+    random.random(u, 64);
+    for (int idx = 0; idx < 64; ++idx) {
+        real d = (idx < 40) ? maxD * real(1.2) * u[(idx * 7) % 64] : edges[idx % 5];
+        real p = std::exp(- d);
+        /* u just below or above p for lanes near maxDEdivKT. */
+        if ((idx % 3) == 0)
+            u[idx] = p * real(0.5);
+        else if ((idx % 3) == 1)
+            u[idx] = std::min(p * real(2.), real(0.99));
+        else if (std::fabs(u[idx] - p) < real(1e-4) * p)
+            u[idx] = p * real(0.9);
+        dEdivKT[idx] = d;
+    }
+}
+
+template<class real>
+void testMetropolis() {
+    Random random;
+    random.seed(0);
+    real dEdivKT[64], u[64];
+    SimdLevel levels[] = { simdScalar, simdAVX2, simdAVX512 };
+    int sizes[] = { 1, 7, 8, 9, 31, 63, 64 };
+
+    for (int iter = 0; iter < 16; ++iter) {
+        createProposals(dEdivKT, u, random);
+        for (SimdLevel level : levels) {
+            setSimdLevel(level);
+            for (int n : sizes) {
+                PackedBits expected = metropolisAcceptScalar(dEdivKT, u, n);
+                check(metropolisAccept(dEdivKT, u, n) == expected, "metropolisAccept(u)", getSimdLevel(), n);
+                /* draws the same uniforms as those of the scalar level. */
+                Random r0, r1;
+                r0.seed(iter);
+                r1.seed(iter);
+                setSimdLevel(simdScalar);
+                expected = metropolisAccept(dEdivKT, r0, n);
+                setSimdLevel(level);
+                check(metropolisAccept(dEdivKT, r1, n) == expected, "metropolisAccept(random)", getSimdLevel(), n);
+            }
+        }
+    }
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+
+/* block generators and bulk draws give the same numbers at all simd levels, and bulk
+ * draws give those of scalar draws. */
+void testRandom() {
+    RandomBackend backends[] = { rngMT19937, rngXoshiro256, rngPhilox };
+    SimdLevel levels[] = { simdScalar, simdAVX2, simdAVX512 };
+    const int n = 3001;
+    for (RandomBackend backend : backends) {
+        std::vector<unsigned long> expected;
+        std::vector<double> expectedF64;
+        std::vector<float> expectedF32;
+        for (SimdLevel level : levels) {
+            setSimdLevel(level);
+            Random r0, r1, r2;
+            r0.setBackend(backend);
+            r1.setBackend(backend);
+            r2.setBackend(backend);
+            r0.seed(1, 3);
+            r1.seed(1, 3);
+            r2.seed(1, 3);
+            std::vector<unsigned long> words(n);
+            for (int idx = 0; idx < n; ++idx)
+                words[idx] = r0.randInt32();
+            /* an odd offset splits a double across refills. */
+            std::vector<double> f64(n);
+            r1.randInt32();
+            r1.random(f64.data(), n);
+            std::vector<float> f32(n);
+            r2.random(f32.data(), n);
+            if (level == simdScalar) {
+                expected = words;
+                Random r;
+                r.setBackend(backend);
+                r.seed(1, 3);
+                r.randInt32();
+                for (int idx = 0; idx < n; ++idx)
+                    expectedF64.push_back(r.randomf64());
+                r.seed(1, 3);
+                for (int idx = 0; idx < n; ++idx)
+                    expectedF32.push_back(r.randomf32());
+            }
+            check(words == expected, "Random::randInt32()", getSimdLevel(), n);
+            check(f64 == expectedF64, "Random::random(double *)", getSimdLevel(), n);
+            check(f32 == expectedF32, "Random::random(float *)", getSimdLevel(), n);
+        }
+    }
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+
+/* 40 free bits of a 200-bit state, with other bits taken from the base. */
+void testBitsSubSpace() {
+    const int N = 200;
+    Random random;
+    random.seed(0);
+    Bits base(N);
+    std::vector<IdxType> subPos;
+    for (int pos = 0; pos < N; ++pos) {
+        base(pos) = (char)random.randInt(2);
+        if (pos % 5 == 3)
+            subPos.push_back(pos);
+    }
+    BitsSubSpace subSpace;
+    subSpace.set(base, subPos);
+    if (subSpace.getNumStates() != (PackedBits(1) << 40)) {
+        std::cerr << "FAILED: BitsSubSpace::getNumStates()" << std::endl;
+        ++nFailures;
+    }
+    for (int iter = 0; iter < 16; ++iter) {
+        PackedBits idx = ((PackedBits)random.randInt32() << 8) ^ random.randInt32();
+        Bits x;
+        subSpace.unpack(&x, idx);
+        bool ok = (x.size == (SizeType)N);
+        for (int pos = 0; ok && (pos < N); ++pos) {
+            char expected = (pos % 5 == 3) ? (char)((idx >> (pos / 5)) & 1) : base(pos);
+            ok = (x(pos) == expected);
+        }
+        if (!ok) {
+            std::cerr << "FAILED: BitsSubSpace::unpack(), idx = " << idx << std::endl;
+            ++nFailures;
+        }
+    }
+}
+
+
+int main() {
+    testMetropolis<float>();
+    testMetropolis<double>();
+    testRandom();
+    testBitsSubSpace();
+    std::cerr << "supported simd level = " << getSupportedSimdLevel()
+              << ", # failures = " << nFailures << std::endl;
+    return (nFailures == 0) ? 0 : 1;
+}
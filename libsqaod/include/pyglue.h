@@ -8,6 +8,8 @@
 #include <numpy/arrayscalars.h>
 #include <common/Matrix.h>
 #include <common/Common.h>
+#include <string>
+#include <stdexcept>
 
 
 template<class real>
@@ -20,6 +22,18 @@ struct NpMatrixType {
         mat.set(data, PyArray_SHAPE(arr)[0], PyArray_SHAPE(arr)[1]);
     }
 
+    NpMatrixType(int nRows, int nCols, int npyType) {
+        /* new array object */
+        npy_intp dims[2];
+        dims[0] = nRows;
+        dims[1] = nCols;
+        obj = PyArray_EMPTY(2, dims, npyType, 0);
+        PyArrayObject *arr = (PyArrayObject*)obj;
+        /* setup members */
+        real *data = (real*)PyArray_DATA(arr);
+        mat.set(data, nRows, nCols);
+    }
+
     void allocate(int nRows, int nCols) {
         /* new array object */
         npy_intp dims[2];
@@ -187,4 +201,22 @@ typedef NpMatrixType<char> NpBitMatrix;
 typedef NpVectorType<char> NpBitVector;
 
 
+/* Releases the GIL around C++ calls.  An exception thrown by the calls is raised as
+ * RuntimeError after the GIL is acquired again, thus callers return NULL if
+ * PyErr_Occurred(). */
+#define BEGIN_ALLOW_THREADS_CATCH { \
+    std::string _cppError; bool _cppThrown = false; \
+    Py_BEGIN_ALLOW_THREADS \
+    try {
+
+#define END_ALLOW_THREADS_CATCH \
+    } catch (const std::exception &e) { \
+        _cppThrown = true; _cppError = e.what(); \
+    } \
+    Py_END_ALLOW_THREADS \
+    if (_cppThrown) \
+        PyErr_SetString(PyExc_RuntimeError, _cppError.c_str()); \
+}
+
+
 #endif
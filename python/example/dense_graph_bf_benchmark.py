@@ -0,0 +1,27 @@
+import sqaod
+import numpy as np
+import time
+
+# compares enumeration engines of the dense graph brute-force solver.
+#   algo_batch_search : E of a tile is calculated by GEMM.
+#   algo_gray_code    : x is walked in gray-code order, E is updated in O(N) per step.
+
+def benchmark(W, algo, n_threads, dtype) :
+    sol = sqaod.cpu.dense_graph_bf_solver(W, sqaod.minimize, dtype)
+    sol.select_algorithm(algo)
+    sol.set_num_threads(n_threads)
+    start = time.time()
+    sol.search()
+    elapsed = time.time() - start
+    return elapsed, sol.get_E()[0]
+
+
+np.random.seed(0)
+dtype = np.float64
+n_threads = 1
+
+for N in [16, 18, 20, 22] :
+    W = sqaod.generate_random_symmetric_W(N, -0.5, 0.5, dtype)
+    for name, algo in [('batch search', sqaod.algo_batch_search), ('gray code', sqaod.algo_gray_code)] :
+        elapsed, E = benchmark(W, algo, n_threads, dtype)
+        print 'N={:2d} {:>12s} : {:8.3f} sec, E={}'.format(N, name, elapsed, E)
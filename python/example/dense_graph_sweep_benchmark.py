@@ -0,0 +1,48 @@
+import sqaod
+import numpy as np
+import time
+import sys
+
+# compares sweep orders of the dense graph annealer.
+#   sweep_random      : (x, y) is drawn at random for each flip.
+#   sweep_sequential  : (x, y) is visited in row-major order.
+#   sweep_permutation : a random permutation of (x, y) per sweep.
+#   sweep_blocked     : tiles of x, all trotters are visited in a tile
+#                       while rows of J in the tile stay in L2.
+# cache misses are counted by running this script under 'perf stat -e cache-misses'
+# with a single order given as an argument, such as 'sequential'.
+
+def benchmark(W, algo, order, n_trotters, dtype) :
+    ann = sqaod.cpu.dense_graph_annealer(W, sqaod.minimize, n_trotters, dtype)
+    ann.select_algorithm(algo)
+    ann.set_sweep_order(order)
+    ann.rand_seed(0)
+    ann.init_anneal()
+    # time per step
+    n_steps = 10
+    start = time.time()
+    for loop in range(n_steps) :
+        ann.anneal_one_step(0.5, 0.1)
+    per_step = (time.time() - start) / n_steps
+    # time to solution
+    start = time.time()
+    E, x = ann.anneal(Ginit = 3., Gfin = 0.01, kT = 0.02, tau = 0.95, n_repeat = 1)
+    tts = time.time() - start
+    return per_step, tts, E
+
+
+orders = [('random', sqaod.sweep_random), ('sequential', sqaod.sweep_sequential),
+          ('permutation', sqaod.sweep_permutation), ('blocked', sqaod.sweep_blocked)]
+if 1 < len(sys.argv) :
+    orders = [order for order in orders if order[0] in sys.argv[1:]]
+
+np.random.seed(0)
+dtype = np.float32
+n_trotters = 16
+
+for N in [256, 1024] :
+    W = sqaod.generate_random_symmetric_W(N, -0.5, 0.5, dtype)
+    for algo_name, algo in [('naive', sqaod.algo_naive), ('local field', sqaod.algo_local_field)] :
+        for name, order in orders :
+            per_step, tts, E = benchmark(W, algo, order, n_trotters, dtype)
+            print 'N={:4d} {:>11s} {:>11s} : {:8.3f} msec/step, {:8.3f} sec to solution, E={}'.format(N, algo_name, name, per_step * 1000., tts, E)
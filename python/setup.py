@@ -6,8 +6,8 @@ def new_ext(name, srcs) :
     ext_includes = [numpy.get_include(), '../libsqaod/include', '../libsqaod', '../libsqaod/eigen']
     ext = Extension(name, srcs,
                     include_dirs=ext_includes,
-                    extra_compile_args = ['-std=c++11'],
-                    extra_link_args = ['-L../libsqaod/.libs', '-lsqaod'])
+                    extra_compile_args = ['-std=c++11', '-fopenmp'],
+                    extra_link_args = ['-L../libsqaod/.libs', '-lsqaod', '-fopenmp'])
     return ext
     
 ext_modules = []
@@ -15,6 +15,15 @@ ext_modules.append(new_ext('sqaod.cpu.cpu_dg_bf_solver', ['sqaod/cpu/src/cpu_dg_
 ext_modules.append(new_ext('sqaod.cpu.cpu_dg_annealer', ['sqaod/cpu/src/cpu_dg_annealer.cpp']))
 ext_modules.append(new_ext('sqaod.cpu.cpu_bg_bf_solver', ['sqaod/cpu/src/cpu_bg_bf_solver.cpp']))
 ext_modules.append(new_ext('sqaod.cpu.cpu_bg_annealer', ['sqaod/cpu/src/cpu_bg_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_sg_annealer', ['sqaod/cpu/src/cpu_sg_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_dg_ms_annealer', ['sqaod/cpu/src/cpu_dg_ms_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_dg_batch_annealer', ['sqaod/cpu/src/cpu_dg_batch_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_bg_batch_annealer', ['sqaod/cpu/src/cpu_bg_batch_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_dg_parallel_tempering', ['sqaod/cpu/src/cpu_dg_parallel_tempering.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_bg_parallel_tempering', ['sqaod/cpu/src/cpu_bg_parallel_tempering.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_dg_pop_annealer', ['sqaod/cpu/src/cpu_dg_pop_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_dg_sa_annealer', ['sqaod/cpu/src/cpu_dg_sa_annealer.cpp']))
+ext_modules.append(new_ext('sqaod.cpu.cpu_bg_sa_annealer', ['sqaod/cpu/src/cpu_bg_sa_annealer.cpp']))
 ext_modules.append(new_ext('sqaod.cpu.cpu_formulas', ['sqaod/cpu/src/cpu_formulas.cpp']))
 
 setup(
@@ -11,6 +11,26 @@ rbm = 2
 bruteforce = 0
 anneal = 1
 
+# annealing algorithms
+
+algo_default = 0
+algo_naive = 1
+algo_local_field = 2
+algo_coloring = 3
+algo_bit_packed = 6
+
+# brute-force search algorithms
+
+algo_batch_search = 4
+algo_gray_code = 5
+
+# sweep orders of annealers
+
+sweep_random = 0
+sweep_sequential = 1
+sweep_permutation = 2
+sweep_blocked = 3
+
 # operations to switch minimize / maximize.
 
 class Minimize :
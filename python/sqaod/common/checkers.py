@@ -94,6 +94,27 @@ class dense_graph :
             raise_dims_dont_match('W, x', (W, x))
         assert_is_bits((x))
 
+# sparse graph
+
+class sparse_graph :
+
+    @staticmethod
+    def qubo(W) :
+        if len(W.shape) != 2 or W.shape[0] != W.shape[1] :
+            raise_wrong_shape('W', W)
+
+    # W should be symmetric, checked on CSR arrays without densifying W.
+    @staticmethod
+    def csr(N, indptr, indices, data) :
+        rows = np.repeat(np.arange(N, dtype = np.int32), np.diff(indptr))
+        order = np.lexsort((indices, rows))
+        order_t = np.lexsort((rows, indices))
+        symmetric = np.array_equal(rows[order], indices[order_t]) and \
+                    np.array_equal(indices[order], rows[order_t]) and \
+                    np.array_equal(data[order], data[order_t])
+        if not symmetric :
+            raise Exception('given W is not symmetric.')
+
 # bipartite_graph
 
 class bipartite_graph :
@@ -132,3 +153,26 @@ class bipartite_graph :
                   (W.shape[0] == x1.shape[len(x1.shape) - 1])
         if not matched :
             raise_dims_dont_match('x0, x1', (x0, x1))
+
+# annealer
+
+class annealer :
+    @staticmethod
+    def schedule(Gfin, tau, n_repeat) :
+        if not (0. < tau and tau < 1.) :
+            raise Exception('tau must be in (0, 1), tau = {}'.format(tau))
+        if not (0. < Gfin) :
+            raise Exception('Gfin must be positive, Gfin = {}'.format(Gfin))
+        if n_repeat < 1 :
+            raise Exception('n_repeat must be a positive integer, n_repeat = {}'.format(n_repeat))
+
+# parallel tempering
+
+class parallel_tempering :
+    @staticmethod
+    def temperatures(kT) :
+        assert_is_vector('kT', kT)
+        if not np.all(0. < kT) :
+            raise Exception('kT must be positive, kT = {}'.format(kT))
+        if not np.all(kT[:-1] < kT[1:]) :
+            raise Exception('kT must be in ascending order, kT = {}'.format(kT))
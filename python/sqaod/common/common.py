@@ -63,6 +63,23 @@ def clone_as_ndarray(var, dtype) :
     clone[...] = var[...]
     return clone
 
+# converts a dense ndarray or a scipy.sparse matrix to CSR arrays, (indptr, indices, data).
+def csr_from_matrix(W, dtype) :
+    if hasattr(W, 'tocsr') :
+        W = W.tocsr(copy = True)
+        W.sum_duplicates()
+        W.eliminate_zeros()
+        indptr, indices, data = W.indptr, W.indices, W.data
+    else :
+        W = np.asarray(W)
+        rows, indices = np.nonzero(W)
+        data = W[rows, indices]
+        indptr = np.zeros((W.shape[0] + 1), np.int32)
+        np.cumsum(np.bincount(rows, minlength = W.shape[0]), out = indptr[1:])
+    return (np.ascontiguousarray(indptr, np.int32),
+            np.ascontiguousarray(indices, np.int32),
+            np.ascontiguousarray(data, dtype))
+
 def clone_as_ndarray_from_vars(vars, dtype) :
     cloned = []
     for var in vars :
@@ -105,6 +122,11 @@ def bits_from_qbits(q) :
 
 
 def anneal(annealer, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10, verbose = False) :
+    # annealers with a native schedule loop run it without per-step python calls.
+    if not verbose and hasattr(annealer, 'anneal') :
+        annealer.anneal(Ginit, Gfin, kT, tau, n_repeat)
+        return
+
     Emin = sys.float_info.max
     q0 = []
     q1 = []
@@ -3,4 +3,13 @@ from dense_graph_annealer import dense_graph_annealer
 from dense_graph_bf_solver import dense_graph_bf_solver
 from bipartite_graph_annealer import bipartite_graph_annealer
 from bipartite_graph_bf_solver import bipartite_graph_bf_solver
+from sparse_graph_annealer import sparse_graph_annealer
 
+from dense_graph_multispin_annealer import dense_graph_multispin_annealer
+from dense_graph_batch_annealer import dense_graph_batch_annealer
+from bipartite_graph_batch_annealer import bipartite_graph_batch_annealer
+from dense_graph_parallel_tempering import dense_graph_parallel_tempering
+from bipartite_graph_parallel_tempering import bipartite_graph_parallel_tempering
+from dense_graph_population_annealer import dense_graph_population_annealer
+from dense_graph_sa_annealer import dense_graph_sa_annealer
+from bipartite_graph_sa_annealer import bipartite_graph_sa_annealer
@@ -39,6 +39,15 @@ class BipartiteGraphAnnealer :
         bg_annealer.set_solver_preference(self._ext, n_trotters, self.dtype);
         N0, N1, m = self.get_problem_size()
         self._E = np.empty((m), self.dtype)
+
+    def select_algorithm(self, algo = sqaod.algo_default) :
+        bg_annealer.select_algorithm(self._ext, algo, self.dtype)
+
+    def set_sweep_order(self, order = sqaod.sweep_random) :
+        bg_annealer.set_sweep_order(self._ext, order, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        bg_annealer.set_num_threads(self._ext, n_threads, self.dtype)
         
     def get_E(self) :
         return self._E
@@ -81,6 +90,28 @@ class BipartiteGraphAnnealer :
         self._E = np.empty((m), self.dtype)
         bg_annealer.get_E(self._ext, self._E, self.dtype)
 
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # runs whole annealing schedules in C++, returns the best E and (x0, x1).
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x = bg_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        N0, N1, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        bg_annealer.get_E(self._ext, self._E, self.dtype)
+        return E, x
+
+    def set_stopping_policy(self, n_frozen_steps = 0, max_acceptance_rate = 0., track_energy = False) :
+        # anneal() ends a schedule after n_frozen_steps consecutive steps whose acceptance
+        # rates are at most max_acceptance_rate, and, with track_energy, which did not
+        # improve the best energy.  n_frozen_steps = 0 runs whole schedules.
+        bg_annealer.set_stopping_policy(self._ext, track_energy, max_acceptance_rate, n_frozen_steps, self.dtype)
+
+    def get_anneal_statistics(self) :
+        # statistics of steps since the last randomize_q() or set_x() as a dict.
+        return bg_annealer.get_anneal_statistics(self._ext, self.dtype)
+
+    def get_acceptance_rates(self) :
+        return bg_annealer.get_acceptance_rates(self._ext, self.dtype)
+
         
 def bipartite_graph_annealer(b0 = None, b1 = None, W = None, \
                              optimize = sqaod.minimize, n_trotters = None, \
@@ -0,0 +1,92 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_bg_batch_annealer as bg_batch_annealer
+
+# anneals a batch of bipartite graph problems of the same (N0, N1) at once.
+# b0, b1 and W are given as (n_problems, N0), (n_problems, N1) and (n_problems, N1, N0)
+# arrays, and get_E() / get_x() return arrays stacked over problems.
+class BipartiteGraphBatchAnnealer :
+
+    def __init__(self, b0, b1, W, optimize, n_trotters, dtype) :
+        self.dtype = dtype
+        self._ext = bg_batch_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problems(b0, b1, W, optimize)
+        if not n_trotters is None :
+            self.set_solver_preference(n_trotters)
+
+    def __del__(self) :
+        bg_batch_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        bg_batch_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problems(self, b0, b1, W, optimize = sqaod.minimize) :
+        b0, b1, W = sqaod.clone_as_ndarray_from_vars([b0, b1, W], self.dtype)
+        if len(W.shape) != 3 :
+            checkers.raise_wrong_shape('W', W)
+        if (b0.shape[0] != W.shape[0]) or (b1.shape[0] != W.shape[0]) :
+            checkers.raise_dims_dont_match('b0, b1, W', (b0, b1, W))
+        for b0p, b1p, Wp in zip(b0, b1, W) :
+            checkers.bipartite_graph.qubo(b0p, b1p, Wp)
+        n_problems, N1, N0 = W.shape
+        bg_batch_annealer.set_problems(self._ext, b0, b1, W.reshape(n_problems * N1, N0),
+                                       optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return bg_batch_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_trotters) :
+        bg_batch_annealer.set_solver_preference(self._ext, n_trotters, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        bg_batch_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    # returns x0 and x1 as (n_problems, m, N0) and (n_problems, m, N1) arrays.
+    def get_x(self) :
+        n_problems, N0, N1, m = self.get_problem_size()
+        x0, x1 = bg_batch_annealer.get_x(self._ext, self.dtype)
+        return x0.reshape(n_problems, m, N0), x1.reshape(n_problems, m, N1)
+
+    def randomize_q(self) :
+        bg_batch_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        bg_batch_annealer.calculate_E(self._ext, self.dtype)
+        self._update_E()
+
+    def init_anneal(self) :
+        bg_batch_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        bg_batch_annealer.fin_anneal(self._ext, self.dtype)
+        self._update_E()
+
+    def anneal_one_step(self, G, kT) :
+        bg_batch_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # returns the best E (n_problems), x0 (n_problems, N0) and x1 (n_problems, N1).
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x0, x1 = bg_batch_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        self._update_E()
+        return E, x0, x1
+
+    def _update_E(self) :
+        n_problems, N0, N1, m = self.get_problem_size()
+        self._E = np.empty((n_problems, m), self.dtype)
+        bg_batch_annealer.get_E(self._ext, self._E, self.dtype)
+
+
+def bipartite_graph_batch_annealer(b0 = None, b1 = None, W = None, \
+                                   optimize = sqaod.minimize, n_trotters = None, \
+                                   dtype = np.float64) :
+    return BipartiteGraphBatchAnnealer(b0, b1, W, optimize, n_trotters, dtype)
@@ -24,6 +24,35 @@ class BipartiteGraphBFSolver :
         bg_bf_solver.set_problem(self._ext, b0, b1, W, optimize, self.dtype)
         self._optimize = optimize
 
+    def set_clamped_bits(self, mask0, x0, mask1, x1) :
+        # fixes x0[i] for mask0[i] != 0 and x1[j] for mask1[j] != 0, and enumerates
+        # other bits.  get_x() gives whole (x0, x1).
+        mask0, x0, mask1, x1 = sqaod.clone_as_ndarray_from_vars([mask0, x0, mask1, x1], np.int8)
+        bg_bf_solver.set_clamped_bits(self._ext, mask0, x0, mask1, x1, self.dtype)
+
+    def clear_clamped_bits(self) :
+        bg_bf_solver.clear_clamped_bits(self._ext, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        bg_bf_solver.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def set_top_k(self, K = 1) :
+        # K = 1 gives all (x0, x1) at the minimum E.  K > 1 gives the K lowest states
+        # in ascending order of E (descending for maximize).
+        bg_bf_solver.set_top_k(self._ext, K, self.dtype)
+
+    def set_max_n_min_states(self, n = 65536) :
+        # max number of (x0, x1) stored at the minimum E with K = 1.  0 only counts minima.
+        bg_bf_solver.set_max_n_min_states(self._ext, n, self.dtype)
+
+    def get_n_min_states(self) :
+        # number of (x0, x1) at the minimum E, including those not stored.
+        return bg_bf_solver.get_n_min_states(self._ext, self.dtype)
+
+    def get_min_E(self) :
+        # minimum E, which is also given when no state is stored.
+        return bg_bf_solver.get_min_E(self._ext, self.dtype)
+
     def get_optimize_dir(self) :
         return self._optimize
 
@@ -40,30 +69,18 @@ class BipartiteGraphBFSolver :
         bg_bf_solver.fin_search(self._ext, self.dtype);
         
     def search_range(self, iBegin0, iEnd0, iBegin1, iEnd1) :
+        # searches x0 in [iBegin0, iEnd0) and x1 in [iBegin1, iEnd1) on one thread.
         bg_bf_solver.search_range(self._ext, iBegin0, iEnd0, iBegin1, iEnd1, self.dtype)
         
     def _search(self) :
         # one liner.  does not accept ctrl+c.
         bg_bf_solver.search(self._ext, self.dtype);
-        
 
     def search(self) :
-        nStep = 1024
-        self.init_search()
-
-        N0, N1 = self._dim[0], self._dim[1]
-        iMax = 1 << N0
-        jMax = 1 << N1
-
-        iStep = min(nStep, iMax)
-        jStep = min(nStep, jMax)
-        for iTile in range(0, iMax, iStep) :
-            for jTile in range(0, jMax, jStep) :
-                self.search_range(iTile, iTile + iStep, jTile, jTile + jStep)
-        
-        self.fin_search()
+        # searches tiles on all threads.  call init_search(), search_range() and
+        # fin_search() for a search which can be interrupted between ranges.
+        bg_bf_solver.search(self._ext, self.dtype)
 
-        
 
 def bipartite_graph_bf_solver(b0 = None, b1 = None, W = None, optimize = sqaod.minimize, dtype = np.float64) :
     return BipartiteGraphBFSolver(b0, b1, W, optimize, dtype)
@@ -0,0 +1,80 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_bg_parallel_tempering as bg_pt
+
+# parallel tempering (replica exchange) of a bipartite graph problem.
+# a replica per temperature in kT, given in ascending order.  get_E() / get_x() return
+# replicas ordered by temperatures, and get_swap_acceptance_rates() returns accepted / attempted
+# swaps between adjacent temperatures to tune kT.
+class BipartiteGraphParallelTempering :
+
+    def __init__(self, b0, b1, W, optimize, kT, dtype) :
+        self.dtype = dtype
+        self._ext = bg_pt.new_solver(dtype)
+        if not W is None :
+            self.set_problem(b0, b1, W, optimize)
+        if not kT is None :
+            self.set_temperatures(kT)
+
+    def __del__(self) :
+        bg_pt.delete_solver(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        bg_pt.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, b0, b1, W, optimize = sqaod.minimize) :
+        checkers.bipartite_graph.qubo(b0, b1, W)
+        b0, b1, W = sqaod.clone_as_ndarray_from_vars([b0, b1, W], self.dtype)
+        bg_pt.set_problem(self._ext, b0, b1, W, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return bg_pt.get_problem_size(self._ext, self.dtype)
+
+    def set_temperatures(self, kT) :
+        kT = sqaod.clone_as_ndarray(kT, self.dtype)
+        checkers.parallel_tempering.temperatures(kT)
+        bg_pt.set_temperatures(self._ext, kT, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        bg_pt.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return bg_pt.get_x(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        bg_pt.randomize_q(self._ext, self.dtype)
+
+    def init_anneal(self) :
+        bg_pt.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        bg_pt.fin_anneal(self._ext, self.dtype)
+        N0, N1, n_replicas = self.get_problem_size()
+        self._E = np.empty((n_replicas), self.dtype)
+        bg_pt.get_E(self._ext, self._E, self.dtype)
+
+    def run(self, n_exchanges, n_sweeps = 1) :
+        bg_pt.run(self._ext, n_exchanges, n_sweeps, self.dtype)
+
+    def get_best(self) :
+        # returns the best E, x0 and x1 found since the last randomize_q().
+        return bg_pt.get_best(self._ext, self.dtype)
+
+    def get_swap_acceptance_rates(self) :
+        return bg_pt.get_swap_acceptance_rates(self._ext, self.dtype)
+
+    def reset_statistics(self) :
+        bg_pt.reset_statistics(self._ext, self.dtype)
+
+
+def bipartite_graph_parallel_tempering(b0 = None, b1 = None, W = None, optimize=sqaod.minimize,
+                                       kT = None, dtype=np.float64) :
+    return BipartiteGraphParallelTempering(b0, b1, W, optimize, kT, dtype)
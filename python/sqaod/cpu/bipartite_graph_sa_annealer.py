@@ -0,0 +1,103 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_bg_sa_annealer as bg_sa_annealer
+
+
+class BipartiteGraphSAAnnealer :
+    # classical simulated annealing with the interface of BipartiteGraphAnnealer.
+    # anneal_one_step(G, kT) anneals at the temperature of max(G, kT).
+
+    def __init__(self, b0, b1, W, optimize, n_restarts, dtype) :
+        self.dtype = dtype
+        self._ext = bg_sa_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problem(b0, b1, W, optimize)
+        if not n_restarts is None :
+            self.set_solver_preference(n_restarts)
+
+    def __del__(self) :
+        bg_sa_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        bg_sa_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, b0, b1, W, optimize = sqaod.minimize) :
+        checkers.bipartite_graph.qubo(b0, b1, W)
+        b0, b1, W = sqaod.clone_as_ndarray_from_vars([b0, b1, W], self.dtype)
+        bg_sa_annealer.set_problem(self._ext, b0, b1, W, optimize, self.dtype);
+        self._optimize = optimize
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_problem_size(self) :
+        return bg_sa_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_restarts) :
+        # set the number of independent restarts.  The default value is (N0 + N1) / 4.
+        bg_sa_annealer.set_solver_preference(self._ext, n_restarts, self.dtype);
+        N0, N1, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+
+    def set_sweep_order(self, order = sqaod.sweep_random) :
+        bg_sa_annealer.set_sweep_order(self._ext, order, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        bg_sa_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return bg_sa_annealer.get_x(self._ext, self.dtype)
+
+    def set_x(self, x0, x1) :
+        bg_sa_annealer.set_x(self._ext, x0, x1, self.dtype)
+
+    # Ising model / spins
+
+    def get_hJc(self) :
+        N0, N1, m = self.get_problem_size()
+        h0 = np.ndarray((N0), self.dtype);
+        h1 = np.ndarray((N1), self.dtype);
+        J = np.ndarray((N1, N0), self.dtype);
+        c = np.ndarray((1), self.dtype)
+        bg_sa_annealer.get_hJc(self._ext, h0, h1, J, c, self.dtype)
+        return h0, h1, J, c[0]
+
+    def get_q(self) :
+        return bg_sa_annealer.get_q(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        bg_sa_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        bg_sa_annealer.calculate_E(self._ext, self.dtype)
+
+    def init_anneal(self) :
+        bg_sa_annealer.init_anneal(self._ext, self.dtype)
+
+    def anneal_one_step(self, G, kT) :
+        bg_sa_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def fin_anneal(self) :
+        bg_sa_annealer.fin_anneal(self._ext, self.dtype)
+        N0, N1, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        bg_sa_annealer.get_E(self._ext, self._E, self.dtype)
+
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # runs whole annealing schedules in C++, returns the best E and (x0, x1).
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x = bg_sa_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        N0, N1, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        bg_sa_annealer.get_E(self._ext, self._E, self.dtype)
+        return E, x
+
+
+def bipartite_graph_sa_annealer(b0 = None, b1 = None, W = None, \
+                                optimize = sqaod.minimize, n_restarts = None, \
+                                dtype = np.float64) :
+    return BipartiteGraphSAAnnealer(b0, b1, W, optimize, n_restarts, dtype)
@@ -0,0 +1,86 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_dg_batch_annealer as dg_batch_annealer
+
+# anneals a batch of dense graph problems of the same N at once.
+# W is given as a (n_problems, N, N) array, and get_E() / get_x() return arrays
+# stacked over problems, (n_problems, m) and (n_problems, m, N).
+class DenseGraphBatchAnnealer :
+
+    def __init__(self, W, optimize, n_trotters, dtype) :
+        self.dtype = dtype
+        self._ext = dg_batch_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problems(W, optimize)
+        if not n_trotters is None :
+            self.set_solver_preference(n_trotters)
+
+    def __del__(self) :
+        dg_batch_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        dg_batch_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problems(self, W, optimize = sqaod.minimize) :
+        W = sqaod.clone_as_ndarray(W, self.dtype)
+        if len(W.shape) != 3 :
+            checkers.raise_wrong_shape('W', W)
+        for Wp in W :
+            checkers.dense_graph.qubo(Wp)
+        n_problems, N = W.shape[0], W.shape[1]
+        dg_batch_annealer.set_problems(self._ext, W.reshape(n_problems * N, N), optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return dg_batch_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_trotters) :
+        dg_batch_annealer.set_solver_preference(self._ext, n_trotters, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        dg_batch_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        n_problems, N, m = self.get_problem_size()
+        x = dg_batch_annealer.get_x(self._ext, self.dtype)
+        return x.reshape(n_problems, m, N)
+
+    def randomize_q(self) :
+        dg_batch_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        dg_batch_annealer.calculate_E(self._ext, self.dtype)
+        self._update_E()
+
+    def init_anneal(self) :
+        dg_batch_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        dg_batch_annealer.fin_anneal(self._ext, self.dtype)
+        self._update_E()
+
+    def anneal_one_step(self, G, kT) :
+        dg_batch_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # returns the best E (n_problems) and x (n_problems, N) of each problem.
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x = dg_batch_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        self._update_E()
+        return E, x
+
+    def _update_E(self) :
+        n_problems, N, m = self.get_problem_size()
+        self._E = np.empty((n_problems, m), self.dtype)
+        dg_batch_annealer.get_E(self._ext, self._E, self.dtype)
+
+
+def dense_graph_batch_annealer(W = None, optimize=sqaod.minimize, n_trotters = None, dtype=np.float64) :
+    return DenseGraphBatchAnnealer(W, optimize, n_trotters, dtype)
@@ -18,9 +18,43 @@ class DenseGraphBFSolver :
         checkers.dense_graph.qubo(W)
         W = sqaod.clone_as_ndarray(W, self.dtype)
         self._N = W.shape[0]
+        self._n_free = self._N
         dg_bf_solver.set_problem(self._ext, W, optimize, self.dtype)
         self._optimize = optimize
 
+    def set_clamped_bits(self, mask, x) :
+        # fixes x[i] for mask[i] != 0, and enumerates other bits.  get_x() gives whole x.
+        mask, x = sqaod.clone_as_ndarray_from_vars([mask, x], np.int8)
+        dg_bf_solver.set_clamped_bits(self._ext, mask, x, self.dtype)
+        self._n_free = self._N - np.count_nonzero(mask)
+
+    def clear_clamped_bits(self) :
+        dg_bf_solver.clear_clamped_bits(self._ext, self.dtype)
+        self._n_free = self._N
+
+    def select_algorithm(self, algo = sqaod.algo_default) :
+        dg_bf_solver.select_algorithm(self._ext, algo, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        dg_bf_solver.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def set_top_k(self, K = 1) :
+        # K = 1 gives all x at the minimum E.  K > 1 gives the K lowest states in
+        # ascending order of E (descending for maximize).
+        dg_bf_solver.set_top_k(self._ext, K, self.dtype)
+
+    def set_max_n_min_states(self, n = 65536) :
+        # max number of x stored at the minimum E with K = 1.  0 only counts minima.
+        dg_bf_solver.set_max_n_min_states(self._ext, n, self.dtype)
+
+    def get_n_min_states(self) :
+        # number of x at the minimum E, including those not stored.
+        return dg_bf_solver.get_n_min_states(self._ext, self.dtype)
+
+    def get_min_E(self) :
+        # minimum E, which is also given when no state is stored.
+        return dg_bf_solver.get_min_E(self._ext, self.dtype)
+
     def get_optimize_dir(self) :
         return self._optimize
 
@@ -36,21 +70,22 @@ class DenseGraphBFSolver :
     def fin_search(self) :
         dg_bf_solver.fin_search(self._ext, self.dtype);
         
-    def search_range(self, iBegin0, iEnd0, iBegin1, iEnd1) :
-        dg_bf_solver.search_range(self._ext, iBegin0, iEnd0, iBegin1, iEnd1, self.dtype)
+    def search_range(self, iBegin, iEnd) :
+        # searches [iBegin, iEnd) on all threads.  Indices are x with algo_batch_search,
+        # and gray-code positions, x = i ^ (i >> 1), with algo_gray_code.  Ranges give
+        # the same x in both only if they cover [0, 2^n).
+        dg_bf_solver.search_range(self._ext, iBegin, iEnd, self.dtype)
         
     def search(self) :
-        N = self._N
-        iMax = 1 << N
-        iStep = min(256, iMax)
+        # ranges are searched on all threads, and ctrl+c is accepted between ranges.
+        iMax = 1 << self._n_free
+        iStep = min(1 << 20, iMax)
         self.init_search()
-        for iTile in range(0, iMax, iStep) :
-            dg_bf_solver.search_range(self._ext, iTile, iTile + iStep, self.dtype)
+        iBegin = 0
+        while iBegin < iMax :
+            dg_bf_solver.search_range(self._ext, iBegin, iBegin + iStep, self.dtype)
+            iBegin += iStep
         self.fin_search()
-        
-    def _search(self) :
-        # one liner.  does not accept ctrl+c.
-        dg_bf_solver.search(self._ext, self.dtype)
 
 
 def dense_graph_bf_solver(W = None, optimize = sqaod.minimize, dtype=np.float64) :
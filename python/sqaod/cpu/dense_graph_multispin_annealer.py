@@ -0,0 +1,93 @@
+import numpy as np
+import random
+import sqaod
+from sqaod.common import checkers
+import cpu_dg_ms_annealer as dg_ms_annealer
+
+# anneals 64 replicas of a dense graph problem at once.
+# get_E() / get_x() return values of a replica in the same shapes as DenseGraphAnnealer.
+class DenseGraphMultiSpinAnnealer :
+
+    n_replicas = 64
+
+    def __init__(self, W, optimize, n_trotters, dtype) :
+        self.dtype = dtype
+        self._ext = dg_ms_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problem(W, optimize)
+        if not n_trotters is None :
+            self.set_solver_preference(n_trotters)
+
+    def __del__(self) :
+        dg_ms_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        dg_ms_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, W, optimize = sqaod.minimize) :
+        checkers.dense_graph.qubo(W)
+        W = sqaod.clone_as_ndarray(W, self.dtype)
+        dg_ms_annealer.set_problem(self._ext, W, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return dg_ms_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_trotters = None) :
+        N, m = self.get_problem_size()
+        n_trotters = max(2, N / 4 if n_trotters is None else n_trotters)
+        dg_ms_annealer.set_solver_preference(self._ext, n_trotters, self.dtype)
+        self._E = np.empty((self.n_replicas, n_trotters), self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    # returns E of all replicas as (n_replicas, m) array if replica is None.
+    def get_E(self, replica = None) :
+        if replica is None :
+            return self._E
+        return self._E[replica]
+
+    def get_x(self, replica = 0) :
+        return dg_ms_annealer.get_x(self._ext, replica, self.dtype)
+
+    def set_x(self, x) :
+        x = sqaod.clone_as_ndarray(x, np.int8)
+        dg_ms_annealer.set_x(self._ext, x, self.dtype)
+
+    def get_hJc(self) :
+        N, m = self.get_problem_size()
+        h = np.empty((N), self.dtype)
+        J = np.empty((N, N), self.dtype)
+        c = np.empty((1), self.dtype)
+        dg_ms_annealer.get_hJc(self._ext, h, J, c, self.dtype)
+        return h, J, c[0]
+
+    def get_q(self, replica = 0) :
+        return dg_ms_annealer.get_q(self._ext, replica, self.dtype)
+
+    def randomize_q(self) :
+        dg_ms_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        dg_ms_annealer.calculate_E(self._ext, self.dtype)
+        self._update_E()
+
+    def init_anneal(self) :
+        dg_ms_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        dg_ms_annealer.fin_anneal(self._ext, self.dtype)
+        self._update_E()
+
+    def anneal_one_step(self, G, kT) :
+        dg_ms_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def _update_E(self) :
+        N, m = self.get_problem_size()
+        self._E = np.empty((self.n_replicas, m), self.dtype)
+        dg_ms_annealer.get_E(self._ext, self._E, self.dtype)
+
+
+def dense_graph_multispin_annealer(W = None, optimize=sqaod.minimize, n_trotters = None, dtype=np.float64) :
+    return DenseGraphMultiSpinAnnealer(W, optimize, n_trotters, dtype)
@@ -0,0 +1,79 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_dg_parallel_tempering as dg_pt
+
+# parallel tempering (replica exchange) of a dense graph problem.
+# a replica per temperature in kT, given in ascending order.  get_E() / get_x() return
+# replicas ordered by temperatures, and get_swap_acceptance_rates() returns accepted / attempted
+# swaps between adjacent temperatures to tune kT.
+class DenseGraphParallelTempering :
+
+    def __init__(self, W, optimize, kT, dtype) :
+        self.dtype = dtype
+        self._ext = dg_pt.new_solver(dtype)
+        if not W is None :
+            self.set_problem(W, optimize)
+        if not kT is None :
+            self.set_temperatures(kT)
+
+    def __del__(self) :
+        dg_pt.delete_solver(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        dg_pt.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, W, optimize = sqaod.minimize) :
+        checkers.dense_graph.qubo(W)
+        W = sqaod.clone_as_ndarray(W, self.dtype)
+        dg_pt.set_problem(self._ext, W, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return dg_pt.get_problem_size(self._ext, self.dtype)
+
+    def set_temperatures(self, kT) :
+        kT = sqaod.clone_as_ndarray(kT, self.dtype)
+        checkers.parallel_tempering.temperatures(kT)
+        dg_pt.set_temperatures(self._ext, kT, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        dg_pt.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return dg_pt.get_x(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        dg_pt.randomize_q(self._ext, self.dtype)
+
+    def init_anneal(self) :
+        dg_pt.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        dg_pt.fin_anneal(self._ext, self.dtype)
+        N, n_replicas = self.get_problem_size()
+        self._E = np.empty((n_replicas), self.dtype)
+        dg_pt.get_E(self._ext, self._E, self.dtype)
+
+    def run(self, n_exchanges, n_sweeps = 1) :
+        dg_pt.run(self._ext, n_exchanges, n_sweeps, self.dtype)
+
+    def get_best(self) :
+        # returns the best E and x found since the last randomize_q().
+        return dg_pt.get_best(self._ext, self.dtype)
+
+    def get_swap_acceptance_rates(self) :
+        return dg_pt.get_swap_acceptance_rates(self._ext, self.dtype)
+
+    def reset_statistics(self) :
+        dg_pt.reset_statistics(self._ext, self.dtype)
+
+
+def dense_graph_parallel_tempering(W = None, optimize=sqaod.minimize, kT = None, dtype=np.float64) :
+    return DenseGraphParallelTempering(W, optimize, kT, dtype)
@@ -0,0 +1,88 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_dg_pop_annealer as dg_pop_annealer
+
+# population annealing of a dense graph problem.
+# a population of n_replicas replicas is annealed by beta = 1 / kT from 0, and resampled
+# by Boltzmann weights at every step.  get_E() / get_x() return the whole population.
+class DenseGraphPopulationAnnealer :
+
+    def __init__(self, W, optimize, n_replicas, dtype) :
+        self.dtype = dtype
+        self._ext = dg_pop_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problem(W, optimize)
+        if not n_replicas is None :
+            self.set_solver_preference(n_replicas)
+
+    def __del__(self) :
+        dg_pop_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        dg_pop_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, W, optimize = sqaod.minimize) :
+        checkers.dense_graph.qubo(W)
+        W = sqaod.clone_as_ndarray(W, self.dtype)
+        dg_pop_annealer.set_problem(self._ext, W, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return dg_pop_annealer.get_problem_size(self._ext, self.dtype)
+
+    # n_sweeps is the number of Metropolis sweeps per step, 0 keeps the current value.
+    def set_solver_preference(self, n_replicas = 0, n_sweeps = 0) :
+        dg_pop_annealer.set_solver_preference(self._ext, n_replicas, n_sweeps, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        dg_pop_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return dg_pop_annealer.get_x(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        dg_pop_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        dg_pop_annealer.calculate_E(self._ext, self.dtype)
+        self._update_E()
+
+    def init_anneal(self) :
+        dg_pop_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        dg_pop_annealer.fin_anneal(self._ext, self.dtype)
+        self._update_E()
+
+    def anneal_one_step(self, beta) :
+        beta = self.dtype(beta)
+        dg_pop_annealer.anneal_one_step(self._ext, beta, self.dtype)
+
+    def anneal(self, beta_fin = 10., n_steps = 100) :
+        # returns the best E and x of the population through steps.
+        if not (0. < beta_fin) :
+            raise Exception('beta_fin must be positive, beta_fin = {}'.format(beta_fin))
+        if n_steps < 1 :
+            raise Exception('n_steps must be a positive integer, n_steps = {}'.format(n_steps))
+        E, x = dg_pop_annealer.anneal(self._ext, beta_fin, n_steps, self.dtype)
+        self._update_E()
+        return E, x
+
+    def get_num_families(self) :
+        return dg_pop_annealer.get_num_families(self._ext, self.dtype)
+
+    def _update_E(self) :
+        N, n_replicas = self.get_problem_size()
+        self._E = np.empty((n_replicas), self.dtype)
+        dg_pop_annealer.get_E(self._ext, self._E, self.dtype)
+
+
+def dense_graph_population_annealer(W = None, optimize=sqaod.minimize, n_replicas = None, dtype=np.float64) :
+    return DenseGraphPopulationAnnealer(W, optimize, n_replicas, dtype)
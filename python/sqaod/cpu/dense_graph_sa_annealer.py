@@ -0,0 +1,107 @@
+import numpy as np
+import sqaod
+from sqaod.common import checkers
+import cpu_dg_sa_annealer as dg_sa_annealer
+
+class DenseGraphSAAnnealer :
+    # classical simulated annealing with the interface of DenseGraphAnnealer.
+    # anneal_one_step(G, kT) anneals at the temperature of max(G, kT).
+
+    def __init__(self, W, optimize, n_restarts, dtype) :
+        self.dtype = dtype
+        self._ext = dg_sa_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problem(W, optimize)
+        if not n_restarts is None :
+            self.set_solver_preference(n_restarts)
+
+    def __del__(self) :
+        dg_sa_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        dg_sa_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    def set_problem(self, W, optimize = sqaod.minimize) :
+        checkers.dense_graph.qubo(W)
+        W = sqaod.clone_as_ndarray(W, self.dtype)
+        dg_sa_annealer.set_problem(self._ext, W, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return dg_sa_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_restarts = None) :
+        # set the number of independent restarts.  The default value is N / 4.
+        N, m = self.get_problem_size()
+        n_restarts = max(1, N / 4 if n_restarts is None else n_restarts)
+        dg_sa_annealer.set_solver_preference(self._ext, n_restarts, self.dtype)
+        self._E = np.empty((n_restarts), self.dtype)
+
+    def set_sweep_order(self, order = sqaod.sweep_random) :
+        dg_sa_annealer.set_sweep_order(self._ext, order, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        dg_sa_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return dg_sa_annealer.get_x(self._ext, self.dtype)
+
+    def set_x(self, x) :
+        dg_sa_annealer.set_x(self._ext, x, self.dtype)
+
+    def get_hJc(self) :
+        N, m = self.get_problem_size()
+        h = np.empty((N), self.dtype)
+        J = np.empty((N, N), self.dtype)
+        c = np.empty((1), self.dtype)
+        dg_sa_annealer.get_hJc(self._ext, h, J, c, self.dtype)
+        return h, J, c[0]
+
+    def get_q(self) :
+        return dg_sa_annealer.get_q(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        dg_sa_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        dg_sa_annealer.calculate_E(self._ext, self.dtype)
+
+    def init_anneal(self) :
+        dg_sa_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        dg_sa_annealer.fin_anneal(self._ext, self.dtype)
+        N, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        dg_sa_annealer.get_E(self._ext, self._E, self.dtype)
+
+    def anneal_one_step(self, G, kT) :
+        dg_sa_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # runs whole annealing schedules in C++, returns the best E and x.
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x = dg_sa_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        N, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        dg_sa_annealer.get_E(self._ext, self._E, self.dtype)
+        return E, x
+
+
+def dense_graph_sa_annealer(W = None, optimize=sqaod.minimize, n_restarts = None, dtype=np.float64) :
+    return DenseGraphSAAnnealer(W, optimize, n_restarts, dtype)
+
+
+if __name__ == '__main__' :
+    N = 16
+    W = sqaod.generate_random_symmetric_W(N, -0.5, 0.5, np.float64)
+    ann = dense_graph_sa_annealer(W, n_restarts = 8, dtype=np.float64)
+    E, x = ann.anneal(Ginit = 5., Gfin = 0.01, kT = 0., tau = 0.95, n_repeat = 4)
+    print E
+    print x
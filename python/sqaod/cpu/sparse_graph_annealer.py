@@ -0,0 +1,125 @@
+import numpy as np
+import random
+import sqaod
+from sqaod.common import checkers
+import cpu_sg_annealer as sg_annealer
+
+class SparseGraphAnnealer :
+
+    def __init__(self, W, optimize, n_trotters, dtype) :
+        self.dtype = dtype
+        self._ext = sg_annealer.new_annealer(dtype)
+        if not W is None :
+            self.set_problem(W, optimize)
+        if not n_trotters is None :
+            self.set_solver_preference(n_trotters)
+
+    def __del__(self) :
+        sg_annealer.delete_annealer(self._ext, self.dtype)
+
+    def rand_seed(self, seed) :
+        sg_annealer.rand_seed(self._ext, seed, self.dtype)
+
+    # W is a scipy.sparse matrix or a dense ndarray, stored in CSR format.
+    def set_problem(self, W, optimize = sqaod.minimize) :
+        checkers.sparse_graph.qubo(W)
+        N = W.shape[0]
+        indptr, indices, data = sqaod.csr_from_matrix(W, self.dtype)
+        checkers.sparse_graph.csr(N, indptr, indices, data)
+        sg_annealer.set_problem(self._ext, N, indptr, indices, data, optimize, self.dtype)
+        self._optimize = optimize
+
+    def get_problem_size(self) :
+        return sg_annealer.get_problem_size(self._ext, self.dtype)
+
+    def set_solver_preference(self, n_trotters = None) :
+        N, m = self.get_problem_size()
+        n_trotters = max(2, min(N / 4, 64) if n_trotters is None else n_trotters)
+        sg_annealer.set_solver_preference(self._ext, n_trotters, self.dtype)
+        self._E = np.empty((n_trotters), self.dtype)
+
+    def select_algorithm(self, algo = sqaod.algo_default) :
+        sg_annealer.select_algorithm(self._ext, algo, self.dtype)
+
+    def set_sweep_order(self, order = sqaod.sweep_random) :
+        sg_annealer.set_sweep_order(self._ext, order, self.dtype)
+
+    def set_num_threads(self, n_threads) :
+        sg_annealer.set_num_threads(self._ext, n_threads, self.dtype)
+
+    def get_optimize_dir(self) :
+        return self._optimize
+
+    def get_E(self) :
+        return self._E
+
+    def get_x(self) :
+        return sg_annealer.get_x(self._ext, self.dtype)
+
+    # J is returned as scipy.sparse.csr_matrix if scipy is available,
+    # otherwise as CSR arrays, (data, indices, indptr).
+    def get_hJc(self) :
+        N, m = self.get_problem_size()
+        nnz = sg_annealer.get_num_non_zeros(self._ext, self.dtype)
+        h = np.empty((N), self.dtype)
+        indptr = np.empty((N + 1), np.int32)
+        indices = np.empty((nnz), np.int32)
+        data = np.empty((nnz), self.dtype)
+        c = np.empty((1), self.dtype)
+        sg_annealer.get_hJc(self._ext, h, indptr, indices, data, c, self.dtype)
+        try :
+            import scipy.sparse
+            J = scipy.sparse.csr_matrix((data, indices, indptr), shape = (N, N))
+        except ImportError :
+            J = (data, indices, indptr)
+        return h, J, c[0]
+
+    def get_q(self) :
+        return sg_annealer.get_q(self._ext, self.dtype)
+
+    def randomize_q(self) :
+        sg_annealer.randomize_q(self._ext, self.dtype)
+
+    def calculate_E(self) :
+        sg_annealer.calculate_E(self._ext, self.dtype)
+
+    def init_anneal(self) :
+        sg_annealer.init_anneal(self._ext, self.dtype)
+
+    def fin_anneal(self) :
+        sg_annealer.fin_anneal(self._ext, self.dtype)
+        N, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        sg_annealer.get_E(self._ext, self._E, self.dtype)
+
+    def anneal_one_step(self, G, kT) :
+        sg_annealer.anneal_one_step(self._ext, G, kT, self.dtype)
+
+    def anneal(self, Ginit = 5., Gfin = 0.01, kT = 0.02, tau = 0.99, n_repeat = 10) :
+        # runs whole annealing schedules in C++, returns the best E and x.
+        checkers.annealer.schedule(Gfin, tau, n_repeat)
+        E, x = sg_annealer.anneal(self._ext, Ginit, Gfin, kT, tau, n_repeat, self.dtype)
+        N, m = self.get_problem_size()
+        self._E = np.empty((m), self.dtype)
+        sg_annealer.get_E(self._ext, self._E, self.dtype)
+        return E, x
+
+
+def sparse_graph_annealer(W = None, optimize=sqaod.minimize, n_trotters = None, dtype=np.float64) :
+    return SparseGraphAnnealer(W, optimize, n_trotters, dtype)
+
+
+if __name__ == '__main__' :
+
+    # ring of N spins with ferromagnetic couplings.
+    N = 1000
+    W = np.zeros((N, N), np.float64)
+    for i in range(N) :
+        W[i, i] = -1.
+        W[i, (i + 1) % N] = W[(i + 1) % N, i] = -0.5
+
+    ann = sparse_graph_annealer(W, sqaod.minimize, 8)
+    ann.rand_seed(0)
+    E, x = ann.anneal(n_repeat = 1)
+    print E
+    print x
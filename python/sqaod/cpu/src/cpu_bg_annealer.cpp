@@ -247,18 +247,28 @@ PyObject *bg_annealer_get_q(PyObject *module, PyObject *args) {
     RAISE_INVALID_DTYPE(dtype);
 }
     
+template<class real>
+void internal_bg_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUBipartiteGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_annealer_radomize_q(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->randomize_q();
+        internal_bg_annealer_randomize_q<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->randomize_q();
+        internal_bg_annealer_randomize_q<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
@@ -297,6 +307,57 @@ PyObject *bg_annealer_get_hJc(PyObject *module, PyObject *args) {
 }
 
 
+extern "C"
+PyObject *bg_annealer_select_algorithm(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int algo;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &algo, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_annealer_set_sweep_order(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int order;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &order, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
 template<class real>
 void internal_bg_annealer_get_E(PyObject *objExt, PyObject *objE) {
     typedef NpVectorType<real> NpVector;
@@ -323,18 +384,28 @@ PyObject *bg_annealer_get_E(PyObject *module, PyObject *args) {
 }
 
     
+template<class real>
+void internal_bg_annealer_calculate_E(PyObject *objExt) {
+    sqd::CPUBipartiteGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->calculate_E();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_annealer_calculate_E(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->calculate_E();
+        internal_bg_annealer_calculate_E<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->calculate_E();
+        internal_bg_annealer_calculate_E<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
@@ -360,7 +431,10 @@ template<class real>
 void internal_bg_annealer_anneal_one_step(PyObject *objExt, PyObject *objG, PyObject *objKT) {
     typedef NpConstScalarType<real> NpConstScalar;
     NpConstScalar G(objG), kT(objKT);
-    pyobjToCppObj<real>(objExt)->annealOneStep(G, kT);
+    sqd::CPUBipartiteGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(G, kT);
+    END_ALLOW_THREADS_CATCH
 }
 
 
@@ -376,27 +450,140 @@ PyObject *bg_annealer_anneal_one_step(PyObject *module, PyObject *args) {
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
+template<class real>
+void internal_bg_annealer_fin_anneal(PyObject *objExt) {
+    sqd::CPUBipartiteGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->finAnneal();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_annealer_fin_anneal(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->finAnneal();
+        internal_bg_annealer_fin_anneal<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->finAnneal();
+        internal_bg_annealer_fin_anneal<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
     
 
+
+
+template<class real>
+PyObject *internal_bg_annealer_anneal(PyObject *objExt,
+                                      double Ginit, double Gfin, double kT, double tau, int nRepeat) {
+    sqd::CPUBipartiteGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    sqaod::SizeType N0, N1, m;
+    ann->getProblemSize(&N0, &N1, &m);
+
+    real E;
+    sqd::Bits x0, x1;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x0, &x1, (real)Ginit, (real)Gfin, (real)kT, (real)tau, nRepeat);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpBitVector npX0(N0, NPY_INT8), npX1(N1, NPY_INT8);
+    npX0.vec = x0;
+    npX1.vec = x1;
+    return Py_BuildValue("N(NN)", newScalarObj(E), npX0.obj, npX1.obj);
+}
+
+extern "C"
+PyObject *bg_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double Ginit, Gfin, kT, tau;
+    int nRepeat;
+    if (!PyArg_ParseTuple(args, "OddddiO", &objExt, &Ginit, &Gfin, &kT, &tau, &nRepeat, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_annealer_anneal<double>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    else if (isFloat32(dtype))
+        return internal_bg_annealer_anneal<float>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+extern "C"
+PyObject *bg_annealer_set_stopping_policy(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int trackEnergy;
+    double maxAcceptanceRate;
+    sqaod::SizeType nFrozenSteps;
+    if (!PyArg_ParseTuple(args, "OidIO", &objExt, &trackEnergy, &maxAcceptanceRate, &nFrozenSteps, &dtype))
+        return NULL;
+    sqd::StoppingPolicy policy;
+    policy.trackEnergy = (trackEnergy != 0);
+    policy.maxAcceptanceRate = maxAcceptanceRate;
+    policy.nFrozenSteps = nFrozenSteps;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setStoppingPolicy(policy);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setStoppingPolicy(policy);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_annealer_get_anneal_statistics(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqd::AnnealStatistics stats;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getAnnealStatistics(&stats);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getAnnealStatistics(&stats);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("{s:I,s:K,s:d,s:I,s:d,s:I}",
+                         "n_steps", stats.nSteps, "n_flips", stats.nFlips,
+                         "acceptance_rate", stats.acceptanceRate,
+                         "n_best_updates", stats.nBestUpdates, "E_best", stats.Ebest,
+                         "n_frozen_steps", stats.nFrozenSteps);
+}
+
+template<class real>
+PyObject *internal_bg_annealer_get_acceptance_rates(PyObject *objExt, int typenum) {
+    sqd::VectorType<real> rates;
+    pyobjToCppObj<real>(objExt)->getAcceptanceRates(&rates);
+    NpVectorType<real> npRates(rates.size, typenum);
+    npRates.vec = rates;
+    return npRates.obj;
+}
+
+extern "C"
+PyObject *bg_annealer_get_acceptance_rates(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_annealer_get_acceptance_rates<double>(objExt, NPY_FLOAT64);
+    else if (isFloat32(dtype))
+        return internal_bg_annealer_get_acceptance_rates<float>(objExt, NPY_FLOAT32);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
 }
 
 
@@ -410,6 +597,9 @@ PyMethodDef cpu_bg_annealer_methods[] = {
 	{"set_problem", bg_annealer_set_problem, METH_VARARGS},
 	{"get_problem_size", bg_annealer_get_problem_size, METH_VARARGS},
 	{"set_solver_preference", bg_annealer_set_solver_preference, METH_VARARGS},
+	{"select_algorithm", bg_annealer_select_algorithm, METH_VARARGS},
+	{"set_sweep_order", bg_annealer_set_sweep_order, METH_VARARGS},
+	{"set_num_threads", bg_annealer_set_num_threads, METH_VARARGS},
 	{"get_E", bg_annealer_get_E, METH_VARARGS},
 	{"get_x", bg_annealer_get_x, METH_VARARGS},
 	{"set_x", bg_annealer_set_x, METH_VARARGS},
@@ -420,6 +610,10 @@ PyMethodDef cpu_bg_annealer_methods[] = {
 	{"init_anneal", bg_annealer_init_anneal, METH_VARARGS},
 	{"fin_anneal", bg_annealer_fin_anneal, METH_VARARGS},
 	{"anneal_one_step", bg_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", bg_annealer_anneal, METH_VARARGS},
+	{"set_stopping_policy", bg_annealer_set_stopping_policy, METH_VARARGS},
+	{"get_anneal_statistics", bg_annealer_get_anneal_statistics, METH_VARARGS},
+	{"get_acceptance_rates", bg_annealer_get_acceptance_rates, METH_VARARGS},
 	{NULL},
 };
 
@@ -0,0 +1,415 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUBipartiteGraphBatchAnnealer.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue, 
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_BgBatchSolverError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_BgBatchSolverError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+    
+template<class real>
+sqd::CPUBipartiteGraphBatchAnnealer<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUBipartiteGraphBatchAnnealer<real> *>(val);
+}
+
+extern "C"
+PyObject *bg_batch_annealer_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUBipartiteGraphBatchAnnealer<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUBipartiteGraphBatchAnnealer<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *bg_batch_annealer_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_batch_annealer_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_bg_batch_annealer_set_problems(PyObject *objExt,
+                                             PyObject *objB0, PyObject *objB1, PyObject *objW, int opt) {
+    typedef NpMatrixType<real> NpMatrix;
+    NpMatrix b0s(objB0), b1s(objB1), Ws(objW);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblems(b0s, b1s, Ws, om);
+}
+    
+extern "C"
+PyObject *bg_batch_annealer_set_problems(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objB0, *objB1, *objW, *dtype;
+    int opt;
+    if (!PyArg_ParseTuple(args, "OOOOiO", &objExt, &objB0, &objB1, &objW, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_set_problems<double>(objExt, objB0, objB1, objW, opt);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_set_problems<float>(objExt, objB0, objB1, objW, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+extern "C"
+PyObject *bg_batch_annealer_get_problem_size(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType nProblems, N0, N1, m;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&nProblems, &N0, &N1, &m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&nProblems, &N0, &N1, &m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("IIII", nProblems, N0, N1, m);
+}
+    
+extern "C"
+PyObject *bg_batch_annealer_set_solver_preference(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType m = 0;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &m, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumTrotters(m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumTrotters(m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+
+extern "C"
+PyObject *bg_batch_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_bg_batch_annealer_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpMatrixType<real> NpMatrix;
+    NpMatrix E(objE);
+    E.mat.map() = pyobjToCppObj<real>(objExt)->get_E().map();
+}
+
+    
+extern "C"
+PyObject *bg_batch_annealer_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+/* returns x0 and x1 as (nProblems * m, N0) and (nProblems * m, N1) arrays. */
+template<class real>
+PyObject *internal_bg_batch_annealer_get_x(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    const sqaod::BitMatrix &x0 = ann->get_x0(), &x1 = ann->get_x1();
+    NpBitMatrix npX0(x0.rows, x0.cols, NPY_INT8), npX1(x1.rows, x1.cols, NPY_INT8);
+    npX0.mat.map() = x0.map();
+    npX1.mat.map() = x1.map();
+    return Py_BuildValue("NN", npX0.obj, npX1.obj);
+}
+    
+extern "C"
+PyObject *bg_batch_annealer_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_batch_annealer_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_bg_batch_annealer_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+template<class real>
+void internal_bg_batch_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_batch_annealer_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_randomize_q<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_randomize_q<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_bg_batch_annealer_calculate_E(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->calculate_E();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_batch_annealer_calculate_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_calculate_E<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_calculate_E<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+        
+extern "C"
+PyObject *bg_batch_annealer_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_bg_batch_annealer_fin_anneal(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->finAnneal();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_batch_annealer_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_fin_anneal<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_fin_anneal<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_bg_batch_annealer_anneal_one_step(PyObject *objExt, PyObject *objG, PyObject *objKT) {
+    typedef NpConstScalarType<real> NpConstScalar;
+    NpConstScalar G(objG), kT(objKT);
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(G, kT);
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_batch_annealer_anneal_one_step(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objG, *objKT, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objG, &objKT, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_batch_annealer_anneal_one_step<double>(objExt, objG, objKT);
+    else if (isFloat32(dtype))
+        internal_bg_batch_annealer_anneal_one_step<float>(objExt, objG, objKT);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+PyObject *internal_bg_batch_annealer_anneal(PyObject *objExt, int typenum,
+                                            double Ginit, double Gfin, double kT, double tau, int nRepeat) {
+    sqd::CPUBipartiteGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    sqd::VectorType<real> E;
+    sqd::BitMatrix x0, x1;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x0, &x1, (real)Ginit, (real)Gfin, (real)kT, (real)tau, nRepeat);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpVectorType<real> npE(E.size, typenum);
+    npE.vec = E;
+    NpBitMatrix npX0(x0.rows, x0.cols, NPY_INT8), npX1(x1.rows, x1.cols, NPY_INT8);
+    npX0.mat.map() = x0.map();
+    npX1.mat.map() = x1.map();
+    return Py_BuildValue("NNN", npE.obj, npX0.obj, npX1.obj);
+}
+
+extern "C"
+PyObject *bg_batch_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double Ginit, Gfin, kT, tau;
+    int nRepeat;
+    if (!PyArg_ParseTuple(args, "OddddiO", &objExt, &Ginit, &Gfin, &kT, &tau, &nRepeat, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_batch_annealer_anneal<double>(objExt, NPY_FLOAT64, Ginit, Gfin, kT, tau, nRepeat);
+    else if (isFloat32(dtype))
+        return internal_bg_batch_annealer_anneal<float>(objExt, NPY_FLOAT32, Ginit, Gfin, kT, tau, nRepeat);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_bg_batch_annealer_methods[] = {
+	{"new_annealer", bg_batch_annealer_create, METH_VARARGS},
+	{"delete_annealer", bg_batch_annealer_delete, METH_VARARGS},
+	{"rand_seed", bg_batch_annealer_rand_seed, METH_VARARGS},
+	{"set_problems", bg_batch_annealer_set_problems, METH_VARARGS},
+	{"get_problem_size", bg_batch_annealer_get_problem_size, METH_VARARGS},
+	{"set_solver_preference", bg_batch_annealer_set_solver_preference, METH_VARARGS},
+	{"set_num_threads", bg_batch_annealer_set_num_threads, METH_VARARGS},
+	{"get_E", bg_batch_annealer_get_E, METH_VARARGS},
+	{"get_x", bg_batch_annealer_get_x, METH_VARARGS},
+	{"randomize_q", bg_batch_annealer_radomize_q, METH_VARARGS},
+	{"calculate_E", bg_batch_annealer_calculate_E, METH_VARARGS},
+	{"init_anneal", bg_batch_annealer_init_anneal, METH_VARARGS},
+	{"fin_anneal", bg_batch_annealer_fin_anneal, METH_VARARGS},
+	{"anneal_one_step", bg_batch_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", bg_batch_annealer_anneal, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_bg_batch_annealer(void) {
+    PyObject *m;
+    
+    m = Py_InitModule("cpu_bg_batch_annealer", cpu_bg_batch_annealer_methods);
+    import_array();
+    if (m == NULL)
+        return;
+    
+    char name[] = "cpu_bg_batch_annealer.error";
+    Cpu_BgBatchSolverError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_BgBatchSolverError);
+    PyModule_AddObject(m, "error", Cpu_BgBatchSolverError);
+}
@@ -134,6 +134,129 @@ PyObject *bg_bf_solver_set_solver_preference(PyObject *module, PyObject *args) {
     return Py_None;    
 }
 
+template<class real>
+void internal_bg_bf_solver_set_clamped_bits(PyObject *objExt,
+                                            PyObject *objMask0, PyObject *objX0,
+                                            PyObject *objMask1, PyObject *objX1) {
+    NpBitVector mask0(objMask0), x0(objX0), mask1(objMask1), x1(objX1);
+    pyobjToCppObj<real>(objExt)->setClampedBits(mask0, x0, mask1, x1);
+}
+
+extern "C"
+PyObject *bg_bf_solver_set_clamped_bits(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objMask0, *objX0, *objMask1, *objX1, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOOOO", &objExt, &objMask0, &objX0, &objMask1, &objX1, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_bf_solver_set_clamped_bits<double>(objExt, objMask0, objX0, objMask1, objX1);
+    else if (isFloat32(dtype))
+        internal_bg_bf_solver_set_clamped_bits<float>(objExt, objMask0, objX0, objMask1, objX1);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_bf_solver_clear_clamped_bits(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->clearClampedBits();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->clearClampedBits();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_bf_solver_set_top_k(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType K;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &K, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setTopK(K);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setTopK(K);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_bf_solver_set_max_n_min_states(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType maxNumMinStates;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &maxNumMinStates, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setMaxNumMinStates(maxNumMinStates);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setMaxNumMinStates(maxNumMinStates);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_bf_solver_get_n_min_states(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    unsigned long long nMinStates;
+    if (isFloat64(dtype))
+        nMinStates = pyobjToCppObj<double>(objExt)->getNumMinStates();
+    else if (isFloat32(dtype))
+        nMinStates = pyobjToCppObj<float>(objExt)->getNumMinStates();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("K", nMinStates);
+}
+
+extern "C"
+PyObject *bg_bf_solver_get_min_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    double E;
+    if (isFloat64(dtype))
+        E = pyobjToCppObj<double>(objExt)->getMinE();
+    else if (isFloat32(dtype))
+        E = pyobjToCppObj<float>(objExt)->getMinE();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("d", E);
+}
+
+extern "C"
+PyObject *bg_bf_solver_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
 template<class real>
 PyObject *internal_bg_bf_solver_get_x(PyObject *objExt) {
     sqd::CPUBipartiteGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
@@ -195,39 +318,68 @@ PyObject *bg_bf_solver_get_E(PyObject *module, PyObject *args) {
 }
     
 
+template<class real>
+void internal_bg_bf_solver_init_search(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->initSearch();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_bf_solver_init_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->initSearch();
+        internal_bg_bf_solver_init_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->initSearch();
+        internal_bg_bf_solver_init_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
 
+template<class real>
+void internal_bg_bf_solver_fin_search(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->finSearch();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_bf_solver_fin_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->finSearch();
+        internal_bg_bf_solver_fin_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->finSearch();
+        internal_bg_bf_solver_fin_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
     
+template<class real>
+void internal_bg_bf_solver_search_range(PyObject *objExt, unsigned long long iBegin0, unsigned long long iEnd0,
+                                        unsigned long long iBegin1, unsigned long long iEnd1) {
+    sqd::CPUBipartiteGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->searchRange(iBegin0, iEnd0, iBegin1, iEnd1);
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_bf_solver_search_range(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
@@ -235,28 +387,40 @@ PyObject *bg_bf_solver_search_range(PyObject *module, PyObject *args) {
     if (!PyArg_ParseTuple(args, "OKKKKO", &objExt, &iBegin0, &iEnd0, &iBegin1, &iEnd1, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->searchRange(iBegin0, iEnd0, iBegin1, iEnd1);
+        internal_bg_bf_solver_search_range<double>(objExt, iBegin0, iEnd0, iBegin1, iEnd1);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->searchRange(iBegin0, iEnd0, iBegin1, iEnd1);
+        internal_bg_bf_solver_search_range<float>(objExt, iBegin0, iEnd0, iBegin1, iEnd1);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
+template<class real>
+void internal_bg_bf_solver_search(PyObject *objExt) {
+    sqd::CPUBipartiteGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->search();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *bg_bf_solver_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->search();
+        internal_bg_bf_solver_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->search();
+        internal_bg_bf_solver_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
@@ -275,6 +439,13 @@ PyMethodDef cpu_bg_bf_solver_methods[] = {
 	{"rand_seed", bg_bf_solver_rand_seed, METH_VARARGS},
 	{"set_problem", bg_bf_solver_set_problem, METH_VARARGS},
 	{"set_solver_preference", bg_bf_solver_set_solver_preference, METH_VARARGS},
+	{"set_num_threads", bg_bf_solver_set_num_threads, METH_VARARGS},
+	{"set_clamped_bits", bg_bf_solver_set_clamped_bits, METH_VARARGS},
+	{"clear_clamped_bits", bg_bf_solver_clear_clamped_bits, METH_VARARGS},
+	{"set_top_k", bg_bf_solver_set_top_k, METH_VARARGS},
+	{"set_max_n_min_states", bg_bf_solver_set_max_n_min_states, METH_VARARGS},
+	{"get_n_min_states", bg_bf_solver_get_n_min_states, METH_VARARGS},
+	{"get_min_E", bg_bf_solver_get_min_E, METH_VARARGS},
 	{"get_x", bg_bf_solver_get_x, METH_VARARGS},
 	{"get_E", bg_bf_solver_get_E, METH_VARARGS},
 	{"init_search", bg_bf_solver_init_search, METH_VARARGS},
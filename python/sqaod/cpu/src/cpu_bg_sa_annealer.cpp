@@ -0,0 +1,551 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUBipartiteGraphSAAnnealer.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue, 
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_BgSolverError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_BgSolverError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+    
+template<class real>
+sqd::CPUBipartiteGraphSAAnnealer<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUBipartiteGraphSAAnnealer<real> *>(val);
+}
+
+extern "C"
+PyObject *bg_sa_annealer_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUBipartiteGraphSAAnnealer<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUBipartiteGraphSAAnnealer<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *bg_sa_annealer_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_sa_annealer_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_bg_sa_annealer_set_problem(PyObject *objExt,
+                                      PyObject *objB0, PyObject *objB1, PyObject *objW, int opt) {
+    typedef NpMatrixType<real> NpMatrix;
+    typedef NpVectorType<real> NpVector;
+    const NpVector b0(objB0), b1(objB1);
+    const NpMatrix W(objW);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblem(b0, b1, W, om);
+}
+    
+extern "C"
+PyObject *bg_sa_annealer_set_problem(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objB0, *objB1, *objW, *dtype;
+    int opt;
+    if (!PyArg_ParseTuple(args, "OOOOiO", &objExt, &objB0, &objB1, &objW, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_set_problem<double>(objExt, objB0, objB1, objW, opt);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_set_problem<float>(objExt, objB0, objB1, objW, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+    
+extern "C"
+PyObject *bg_sa_annealer_get_problem_size(PyObject *module, PyObject *args) {
+
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType N0, N1, m;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&N0, &N1, &m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&N0, &N1, &m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("III", N0, N1, m);
+}
+    
+extern "C"
+PyObject *bg_sa_annealer_set_solver_preference(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType m = 0;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &m, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumRestarts(m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumRestarts(m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+PyObject *internal_bg_sa_annealer_get_x(PyObject *objExt) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+
+    sqaod::SizeType N0, N1, m;
+    ann->getProblemSize(&N0, &N1, &m);
+    const sqd::BitsPairArray &xPairList = ann->get_x();
+
+    PyObject *list = PyList_New(xPairList.size());
+    for (size_t idx = 0; idx < xPairList.size(); ++idx) {
+        const sqd::BitsPairArray::ValueType &pair = xPairList[idx];
+
+        NpBitVector x0(N0, NPY_INT8), x1(N1, NPY_INT8);
+        x0.vec = pair.first;
+        x1.vec = pair.second;
+
+        PyObject *tuple = PyTuple_New(2);
+        PyTuple_SET_ITEM(tuple, 0, x0.obj);
+        PyTuple_SET_ITEM(tuple, 1, x1.obj);
+        PyList_SET_ITEM(list, idx, tuple);
+    }
+    return list;
+}
+
+
+extern "C"
+PyObject *bg_sa_annealer_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_sa_annealer_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_bg_sa_annealer_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+
+template<class real>
+void internal_bg_sa_annealer_set_x(PyObject *objExt, PyObject *objX0, PyObject *objX1) {
+    NpBitVector x0(objX0), x1(objX1);
+    pyobjToCppObj<real>(objExt)->set_x(x0, x1);
+}
+
+extern "C"
+PyObject *bg_sa_annealer_set_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objX0, *objX1, *dtype;
+    
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objX0, &objX1, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_set_x<double>(objExt, objX0, objX1);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_set_x<float>(objExt, objX0, objX1);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+
+template<class real>
+PyObject *internal_bg_sa_annealer_get_q(PyObject *objExt) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+
+    sqaod::SizeType N0, N1, m;
+    ann->getProblemSize(&N0, &N1, &m);
+    const sqd::BitsPairArray &xPairList = ann->get_q();
+
+    PyObject *list = PyList_New(xPairList.size());
+    for (size_t idx = 0; idx < xPairList.size(); ++idx) {
+        const sqd::BitsPairArray::ValueType &pair = xPairList[idx];
+
+        NpBitVector q0(N0, NPY_INT8), q1(N1, NPY_INT8);
+        q0.vec = pair.first;
+        q1.vec = pair.second;
+
+        PyObject *tuple = PyTuple_New(2);
+        PyTuple_SET_ITEM(tuple, 0, q0.obj);
+        PyTuple_SET_ITEM(tuple, 1, q1.obj);
+        PyList_SET_ITEM(list, idx, tuple);
+    }
+    return list;
+}
+    
+extern "C"
+PyObject *bg_sa_annealer_get_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_sa_annealer_get_q<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_bg_sa_annealer_get_q<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+    
+template<class real>
+void internal_bg_sa_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_sa_annealer_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_randomize_q<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_randomize_q<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_bg_sa_annealer_get_hJc(PyObject *objExt,
+                                  PyObject *objH0, PyObject *objH1,
+                                  PyObject *objJ, PyObject *objC) {
+    typedef NpMatrixType<real> NpMatrix;
+    typedef NpVectorType<real> NpVector;
+    typedef NpScalarRefType<real> NpScalarRef;
+    
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    NpVector h0(objH0), h1(objH1);
+    NpScalarRef c(objC);
+    NpMatrix J(objJ);
+    ann->get_hJc(&h0, &h0, &J, &c);
+}
+    
+    
+extern "C"
+PyObject *bg_sa_annealer_get_hJc(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objH0, *objH1, *objJ, *objC, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOOO", &objExt, &objH0, &objH1, &objJ, &objC, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_get_hJc<double>(objExt, objH0, objH1, objJ, objC);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_get_hJc<float>(objExt, objH0, objH1, objJ, objC);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+extern "C"
+PyObject *bg_sa_annealer_set_sweep_order(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int order;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &order, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *bg_sa_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_bg_sa_annealer_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpVectorType<real> NpVector;
+    NpVector E(objE);
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ext = pyobjToCppObj<real>(objExt);
+    E.vec = ext->get_E();
+}
+
+    
+extern "C"
+PyObject *bg_sa_annealer_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+    
+template<class real>
+void internal_bg_sa_annealer_calculate_E(PyObject *objExt) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->calculate_E();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_sa_annealer_calculate_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_calculate_E<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_calculate_E<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+extern "C"
+PyObject *bg_sa_annealer_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+    
+template<class real>
+void internal_bg_sa_annealer_anneal_one_step(PyObject *objExt, PyObject *objG, PyObject *objKT) {
+    typedef NpConstScalarType<real> NpConstScalar;
+    NpConstScalar G(objG), kT(objKT);
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(G, kT);
+    END_ALLOW_THREADS_CATCH
+}
+
+
+extern "C"
+PyObject *bg_sa_annealer_anneal_one_step(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objG, *objKT, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objG, &objKT, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_anneal_one_step<double>(objExt, objG, objKT);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_anneal_one_step<float>(objExt, objG, objKT);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_bg_sa_annealer_fin_anneal(PyObject *objExt) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->finAnneal();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *bg_sa_annealer_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_bg_sa_annealer_fin_anneal<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_bg_sa_annealer_fin_anneal<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+
+
+
+template<class real>
+PyObject *internal_bg_sa_annealer_anneal(PyObject *objExt,
+                                      double Ginit, double Gfin, double kT, double tau, int nRepeat) {
+    sqd::CPUBipartiteGraphSAAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    sqaod::SizeType N0, N1, m;
+    ann->getProblemSize(&N0, &N1, &m);
+
+    real E;
+    sqd::Bits x0, x1;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x0, &x1, (real)Ginit, (real)Gfin, (real)kT, (real)tau, nRepeat);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpBitVector npX0(N0, NPY_INT8), npX1(N1, NPY_INT8);
+    npX0.vec = x0;
+    npX1.vec = x1;
+    return Py_BuildValue("N(NN)", newScalarObj(E), npX0.obj, npX1.obj);
+}
+
+extern "C"
+PyObject *bg_sa_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double Ginit, Gfin, kT, tau;
+    int nRepeat;
+    if (!PyArg_ParseTuple(args, "OddddiO", &objExt, &Ginit, &Gfin, &kT, &tau, &nRepeat, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_bg_sa_annealer_anneal<double>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    else if (isFloat32(dtype))
+        return internal_bg_sa_annealer_anneal<float>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_bg_sa_annealer_methods[] = {
+	{"new_annealer", bg_sa_annealer_create, METH_VARARGS},
+	{"delete_annealer", bg_sa_annealer_delete, METH_VARARGS},
+	{"rand_seed", bg_sa_annealer_rand_seed, METH_VARARGS},
+	{"set_problem", bg_sa_annealer_set_problem, METH_VARARGS},
+	{"get_problem_size", bg_sa_annealer_get_problem_size, METH_VARARGS},
+	{"set_solver_preference", bg_sa_annealer_set_solver_preference, METH_VARARGS},
+	{"set_sweep_order", bg_sa_annealer_set_sweep_order, METH_VARARGS},
+	{"set_num_threads", bg_sa_annealer_set_num_threads, METH_VARARGS},
+	{"get_E", bg_sa_annealer_get_E, METH_VARARGS},
+	{"get_x", bg_sa_annealer_get_x, METH_VARARGS},
+	{"set_x", bg_sa_annealer_set_x, METH_VARARGS},
+	{"get_hJc", bg_sa_annealer_get_hJc, METH_VARARGS},
+	{"get_q", bg_sa_annealer_get_q, METH_VARARGS},
+	{"randomize_q", bg_sa_annealer_radomize_q, METH_VARARGS},
+	{"calculate_E", bg_sa_annealer_calculate_E, METH_VARARGS},
+	{"init_anneal", bg_sa_annealer_init_anneal, METH_VARARGS},
+	{"fin_anneal", bg_sa_annealer_fin_anneal, METH_VARARGS},
+	{"anneal_one_step", bg_sa_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", bg_sa_annealer_anneal, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_bg_sa_annealer(void) {
+    PyObject *m;
+    
+    m = Py_InitModule("cpu_bg_sa_annealer", cpu_bg_sa_annealer_methods);
+    import_array();
+    if (m == NULL)
+        return;
+    
+    char name[] = "cpu_bg_sa_annealer.error";
+    Cpu_BgSolverError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_BgSolverError);
+    PyModule_AddObject(m, "error", Cpu_BgSolverError);
+}
@@ -0,0 +1,411 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUDenseGraphBatchAnnealer.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue, 
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_DgBatchSolverError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_DgBatchSolverError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+    
+template<class real>
+sqd::CPUDenseGraphBatchAnnealer<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUDenseGraphBatchAnnealer<real> *>(val);
+}
+
+extern "C"
+PyObject *dg_batch_annealer_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUDenseGraphBatchAnnealer<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUDenseGraphBatchAnnealer<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *dg_batch_annealer_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *dg_batch_annealer_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_dg_batch_annealer_set_problems(PyObject *objExt, PyObject *objW, int opt) {
+    typedef NpMatrixType<real> NpMatrix;
+    NpMatrix Ws(objW);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblems(Ws, om);
+}
+    
+extern "C"
+PyObject *dg_batch_annealer_set_problems(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objW, *dtype;
+    int opt;
+    if (!PyArg_ParseTuple(args, "OOiO", &objExt, &objW, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_set_problems<double>(objExt, objW, opt);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_set_problems<float>(objExt, objW, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+extern "C"
+PyObject *dg_batch_annealer_get_problem_size(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType nProblems, N, m;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&nProblems, &N, &m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&nProblems, &N, &m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("III", nProblems, N, m);
+}
+    
+extern "C"
+PyObject *dg_batch_annealer_set_solver_preference(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType m = 0;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &m, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumTrotters(m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumTrotters(m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+
+extern "C"
+PyObject *dg_batch_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_dg_batch_annealer_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpMatrixType<real> NpMatrix;
+    NpMatrix E(objE);
+    E.mat.map() = pyobjToCppObj<real>(objExt)->get_E().map();
+}
+
+    
+extern "C"
+PyObject *dg_batch_annealer_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+/* returns x as (nProblems * m, N) array. */
+template<class real>
+PyObject *internal_dg_batch_annealer_get_x(PyObject *objExt) {
+    const sqaod::BitMatrix &x = pyobjToCppObj<real>(objExt)->get_x();
+    NpBitMatrix npX(x.rows, x.cols, NPY_INT8);
+    npX.mat.map() = x.map();
+    return npX.obj;
+}
+    
+extern "C"
+PyObject *dg_batch_annealer_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_batch_annealer_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_dg_batch_annealer_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+template<class real>
+void internal_dg_batch_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUDenseGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_batch_annealer_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_randomize_q<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_randomize_q<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_dg_batch_annealer_calculate_E(PyObject *objExt) {
+    sqd::CPUDenseGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->calculate_E();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_batch_annealer_calculate_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_calculate_E<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_calculate_E<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+        
+extern "C"
+PyObject *dg_batch_annealer_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_dg_batch_annealer_fin_anneal(PyObject *objExt) {
+    sqd::CPUDenseGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->finAnneal();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_batch_annealer_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_fin_anneal<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_fin_anneal<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_dg_batch_annealer_anneal_one_step(PyObject *objExt, PyObject *objG, PyObject *objKT) {
+    typedef NpConstScalarType<real> NpConstScalar;
+    NpConstScalar G(objG), kT(objKT);
+    sqd::CPUDenseGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(G, kT);
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_batch_annealer_anneal_one_step(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objG, *objKT, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objG, &objKT, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_batch_annealer_anneal_one_step<double>(objExt, objG, objKT);
+    else if (isFloat32(dtype))
+        internal_dg_batch_annealer_anneal_one_step<float>(objExt, objG, objKT);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+PyObject *internal_dg_batch_annealer_anneal(PyObject *objExt, int typenum,
+                                            double Ginit, double Gfin, double kT, double tau, int nRepeat) {
+    sqd::CPUDenseGraphBatchAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    sqd::VectorType<real> E;
+    sqd::BitMatrix x;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x, (real)Ginit, (real)Gfin, (real)kT, (real)tau, nRepeat);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpVectorType<real> npE(E.size, typenum);
+    npE.vec = E;
+    NpBitMatrix npX(x.rows, x.cols, NPY_INT8);
+    npX.mat.map() = x.map();
+    return Py_BuildValue("NN", npE.obj, npX.obj);
+}
+
+extern "C"
+PyObject *dg_batch_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double Ginit, Gfin, kT, tau;
+    int nRepeat;
+    if (!PyArg_ParseTuple(args, "OddddiO", &objExt, &Ginit, &Gfin, &kT, &tau, &nRepeat, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_batch_annealer_anneal<double>(objExt, NPY_FLOAT64, Ginit, Gfin, kT, tau, nRepeat);
+    else if (isFloat32(dtype))
+        return internal_dg_batch_annealer_anneal<float>(objExt, NPY_FLOAT32, Ginit, Gfin, kT, tau, nRepeat);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_dg_batch_annealer_methods[] = {
+	{"new_annealer", dg_batch_annealer_create, METH_VARARGS},
+	{"delete_annealer", dg_batch_annealer_delete, METH_VARARGS},
+	{"rand_seed", dg_batch_annealer_rand_seed, METH_VARARGS},
+	{"set_problems", dg_batch_annealer_set_problems, METH_VARARGS},
+	{"get_problem_size", dg_batch_annealer_get_problem_size, METH_VARARGS},
+	{"set_solver_preference", dg_batch_annealer_set_solver_preference, METH_VARARGS},
+	{"set_num_threads", dg_batch_annealer_set_num_threads, METH_VARARGS},
+	{"get_E", dg_batch_annealer_get_E, METH_VARARGS},
+	{"get_x", dg_batch_annealer_get_x, METH_VARARGS},
+	{"randomize_q", dg_batch_annealer_radomize_q, METH_VARARGS},
+	{"calculate_E", dg_batch_annealer_calculate_E, METH_VARARGS},
+	{"init_anneal", dg_batch_annealer_init_anneal, METH_VARARGS},
+	{"fin_anneal", dg_batch_annealer_fin_anneal, METH_VARARGS},
+	{"anneal_one_step", dg_batch_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", dg_batch_annealer_anneal, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_dg_batch_annealer(void) {
+    PyObject *m;
+    
+    m = Py_InitModule("cpu_dg_batch_annealer", cpu_dg_batch_annealer_methods);
+    import_array();
+    if (m == NULL)
+        return;
+    
+    char name[] = "cpu_dg_batch_annealer.error";
+    Cpu_DgBatchSolverError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_DgBatchSolverError);
+    PyModule_AddObject(m, "error", Cpu_DgBatchSolverError);
+}
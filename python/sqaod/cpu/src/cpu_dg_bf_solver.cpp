@@ -129,6 +129,144 @@ PyObject *dg_bf_solver_set_solver_preference(PyObject *module, PyObject *args) {
     return Py_None;    
 }
 
+extern "C"
+PyObject *dg_bf_solver_select_algorithm(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int algo;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &algo, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_dg_bf_solver_set_clamped_bits(PyObject *objExt, PyObject *objMask, PyObject *objX) {
+    NpBitVector mask(objMask), x(objX);
+    pyobjToCppObj<real>(objExt)->setClampedBits(mask, x);
+}
+
+extern "C"
+PyObject *dg_bf_solver_set_clamped_bits(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objMask, *objX, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objMask, &objX, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_bf_solver_set_clamped_bits<double>(objExt, objMask, objX);
+    else if (isFloat32(dtype))
+        internal_dg_bf_solver_set_clamped_bits<float>(objExt, objMask, objX);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *dg_bf_solver_clear_clamped_bits(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->clearClampedBits();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->clearClampedBits();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *dg_bf_solver_set_top_k(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType K;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &K, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setTopK(K);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setTopK(K);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *dg_bf_solver_set_max_n_min_states(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType maxNumMinStates;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &maxNumMinStates, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setMaxNumMinStates(maxNumMinStates);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setMaxNumMinStates(maxNumMinStates);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *dg_bf_solver_get_n_min_states(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    unsigned long long nMinStates;
+    if (isFloat64(dtype))
+        nMinStates = pyobjToCppObj<double>(objExt)->getNumMinStates();
+    else if (isFloat32(dtype))
+        nMinStates = pyobjToCppObj<float>(objExt)->getNumMinStates();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("K", nMinStates);
+}
+
+extern "C"
+PyObject *dg_bf_solver_get_min_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    double E;
+    if (isFloat64(dtype))
+        E = pyobjToCppObj<double>(objExt)->getMinE();
+    else if (isFloat32(dtype))
+        E = pyobjToCppObj<float>(objExt)->getMinE();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("d", E);
+}
+
+extern "C"
+PyObject *dg_bf_solver_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
 template<class real>
 PyObject *internal_dg_bf_solver_get_x(PyObject *objExt) {
     sqaod::SizeType N;
@@ -182,39 +320,67 @@ PyObject *dg_bf_solver_get_E(PyObject *module, PyObject *args) {
 }
 
 
+template<class real>
+void internal_dg_bf_solver_init_search(PyObject *objExt) {
+    sqd::CPUDenseGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->initSearch();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *dg_bf_solver_init_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->initSearch();
+        internal_dg_bf_solver_init_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->initSearch();
+        internal_dg_bf_solver_init_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
+template<class real>
+void internal_dg_bf_solver_fin_search(PyObject *objExt) {
+    sqd::CPUDenseGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->finSearch();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *dg_bf_solver_fin_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->finSearch();
+        internal_dg_bf_solver_fin_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->finSearch();
+        internal_dg_bf_solver_fin_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
     
+template<class real>
+void internal_dg_bf_solver_search_range(PyObject *objExt, unsigned long long iBegin, unsigned long long iEnd) {
+    sqd::CPUDenseGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->searchRange(iBegin, iEnd);
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *dg_bf_solver_search_range(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
@@ -222,28 +388,40 @@ PyObject *dg_bf_solver_search_range(PyObject *module, PyObject *args) {
     if (!PyArg_ParseTuple(args, "OKKO", &objExt, &iBegin, &iEnd, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->searchRange(iBegin, iEnd);
+        internal_dg_bf_solver_search_range<double>(objExt, iBegin, iEnd);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->searchRange(iBegin, iEnd);
+        internal_dg_bf_solver_search_range<float>(objExt, iBegin, iEnd);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
 
+template<class real>
+void internal_dg_bf_solver_search(PyObject *objExt) {
+    sqd::CPUDenseGraphBFSolver<real> *sol = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    sol->search();
+    END_ALLOW_THREADS_CATCH
+}
+
 extern "C"
 PyObject *dg_bf_solver_search(PyObject *module, PyObject *args) {
     PyObject *objExt, *dtype;
     if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
         return NULL;
     if (isFloat64(dtype))
-        pyobjToCppObj<double>(objExt)->search();
+        internal_dg_bf_solver_search<double>(objExt);
     else if (isFloat32(dtype))
-        pyobjToCppObj<float>(objExt)->search();
+        internal_dg_bf_solver_search<float>(objExt);
     else
         RAISE_INVALID_DTYPE(dtype);
 
+    if (PyErr_Occurred())
+        return NULL;
     Py_INCREF(Py_None);
     return Py_None;    
 }
@@ -262,6 +440,14 @@ PyMethodDef cpu_dg_bf_solver_methods[] = {
 	{"rand_seed", dg_bf_solver_rand_seed, METH_VARARGS},
 	{"set_problem", dg_bf_solver_set_problem, METH_VARARGS},
 	{"set_solver_preference", dg_bf_solver_set_solver_preference, METH_VARARGS},
+	{"select_algorithm", dg_bf_solver_select_algorithm, METH_VARARGS},
+	{"set_num_threads", dg_bf_solver_set_num_threads, METH_VARARGS},
+	{"set_clamped_bits", dg_bf_solver_set_clamped_bits, METH_VARARGS},
+	{"clear_clamped_bits", dg_bf_solver_clear_clamped_bits, METH_VARARGS},
+	{"set_top_k", dg_bf_solver_set_top_k, METH_VARARGS},
+	{"set_max_n_min_states", dg_bf_solver_set_max_n_min_states, METH_VARARGS},
+	{"get_n_min_states", dg_bf_solver_get_n_min_states, METH_VARARGS},
+	{"get_min_E", dg_bf_solver_get_min_E, METH_VARARGS},
 	{"get_x", dg_bf_solver_get_x, METH_VARARGS},
 	{"get_E", dg_bf_solver_get_E, METH_VARARGS},
 	{"init_search", dg_bf_solver_init_search, METH_VARARGS},
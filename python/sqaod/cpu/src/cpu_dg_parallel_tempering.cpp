@@ -0,0 +1,404 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUDenseGraphParallelTempering.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue,
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_DgParallelTemperingError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_DgParallelTemperingError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+
+template<class real>
+sqd::CPUDenseGraphParallelTempering<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUDenseGraphParallelTempering<real> *>(val);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUDenseGraphParallelTempering<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUDenseGraphParallelTempering<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+template<class real>
+void internal_dg_parallel_tempering_set_problem(PyObject *objExt, PyObject *objW, int opt) {
+    typedef NpMatrixType<real> NpMatrix;
+    const NpMatrix W(objW);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblem(W, om);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_set_problem(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objW, *dtype;
+    int opt;
+    if (!PyArg_ParseTuple(args, "OOiO", &objExt, &objW, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_parallel_tempering_set_problem<double>(objExt, objW, opt);
+    else if (isFloat32(dtype))
+        internal_dg_parallel_tempering_set_problem<float>(objExt, objW, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_get_problem_size(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType N, nReplicas;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&N, &nReplicas);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&N, &nReplicas);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("II", N, nReplicas);
+}
+
+template<class real>
+void internal_dg_parallel_tempering_set_temperatures(PyObject *objExt, PyObject *objKT) {
+    typedef NpVectorType<real> NpVector;
+    const NpVector kT(objKT);
+    pyobjToCppObj<real>(objExt)->setTemperatures(kT);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_set_temperatures(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objKT, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objKT, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_parallel_tempering_set_temperatures<double>(objExt, objKT);
+    else if (isFloat32(dtype))
+        internal_dg_parallel_tempering_set_temperatures<float>(objExt, objKT);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+void internal_dg_parallel_tempering_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpVectorType<real> NpVector;
+    NpVector E(objE);
+    E.vec = pyobjToCppObj<real>(objExt)->get_E();
+}
+
+
+extern "C"
+PyObject *dg_parallel_tempering_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_parallel_tempering_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_dg_parallel_tempering_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+template<class real>
+PyObject *internal_dg_parallel_tempering_get_x(PyObject *objExt) {
+    sqd::CPUDenseGraphParallelTempering<real> *pt = pyobjToCppObj<real>(objExt);
+
+    sqaod::SizeType N, nReplicas;
+    pt->getProblemSize(&N, &nReplicas);
+    const sqaod::BitsArray &xList = pt->get_x();
+    PyObject *list = PyList_New(xList.size());
+    for (size_t idx = 0; idx < xList.size(); ++idx) {
+        NpBitVector x(N, NPY_INT8);
+        x.vec = xList[idx];
+        PyList_SET_ITEM(list, idx, x.obj);
+    }
+    return list;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_parallel_tempering_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_dg_parallel_tempering_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->randomize_q();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->randomize_q();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->finAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->finAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+void internal_dg_parallel_tempering_run(PyObject *objExt, int nExchanges, int nSweeps) {
+    sqd::CPUDenseGraphParallelTempering<real> *pt = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    pt->run(nExchanges, nSweeps);
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_run(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nExchanges, nSweeps;
+    if (!PyArg_ParseTuple(args, "OiiO", &objExt, &nExchanges, &nSweeps, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_parallel_tempering_run<double>(objExt, nExchanges, nSweeps);
+    else if (isFloat32(dtype))
+        internal_dg_parallel_tempering_run<float>(objExt, nExchanges, nSweeps);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+PyObject *internal_dg_parallel_tempering_get_best(PyObject *objExt) {
+    sqd::CPUDenseGraphParallelTempering<real> *pt = pyobjToCppObj<real>(objExt);
+    real E;
+    sqd::Bits x;
+    pt->getBest(&E, &x);
+
+    NpBitVector npX(x.size, NPY_INT8);
+    npX.vec = x;
+    return Py_BuildValue("NN", newScalarObj(E), npX.obj);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_get_best(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_parallel_tempering_get_best<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_dg_parallel_tempering_get_best<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+
+template<class real>
+PyObject *internal_dg_parallel_tempering_get_swap_acceptance_rates(PyObject *objExt, int typenum) {
+    sqd::VectorType<real> rates;
+    pyobjToCppObj<real>(objExt)->getSwapAcceptanceRates(&rates);
+    NpVectorType<real> npRates(rates.size, typenum);
+    npRates.vec = rates;
+    return npRates.obj;
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_get_swap_acceptance_rates(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_parallel_tempering_get_swap_acceptance_rates<double>(objExt, NPY_FLOAT64);
+    else if (isFloat32(dtype))
+        return internal_dg_parallel_tempering_get_swap_acceptance_rates<float>(objExt, NPY_FLOAT32);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+extern "C"
+PyObject *dg_parallel_tempering_reset_statistics(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->resetStatistics();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->resetStatistics();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_dg_parallel_tempering_methods[] = {
+	{"new_solver", dg_parallel_tempering_create, METH_VARARGS},
+	{"delete_solver", dg_parallel_tempering_delete, METH_VARARGS},
+	{"rand_seed", dg_parallel_tempering_rand_seed, METH_VARARGS},
+	{"set_problem", dg_parallel_tempering_set_problem, METH_VARARGS},
+	{"get_problem_size", dg_parallel_tempering_get_problem_size, METH_VARARGS},
+	{"set_temperatures", dg_parallel_tempering_set_temperatures, METH_VARARGS},
+	{"set_num_threads", dg_parallel_tempering_set_num_threads, METH_VARARGS},
+	{"get_E", dg_parallel_tempering_get_E, METH_VARARGS},
+	{"get_x", dg_parallel_tempering_get_x, METH_VARARGS},
+	{"randomize_q", dg_parallel_tempering_radomize_q, METH_VARARGS},
+	{"init_anneal", dg_parallel_tempering_init_anneal, METH_VARARGS},
+	{"fin_anneal", dg_parallel_tempering_fin_anneal, METH_VARARGS},
+	{"run", dg_parallel_tempering_run, METH_VARARGS},
+	{"get_best", dg_parallel_tempering_get_best, METH_VARARGS},
+	{"get_swap_acceptance_rates", dg_parallel_tempering_get_swap_acceptance_rates, METH_VARARGS},
+	{"reset_statistics", dg_parallel_tempering_reset_statistics, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_dg_parallel_tempering(void) {
+    PyObject *m;
+
+    m = Py_InitModule("cpu_dg_parallel_tempering", cpu_dg_parallel_tempering_methods);
+    import_array();
+    if (m == NULL)
+        return;
+
+    char name[] = "cpu_dg_parallel_tempering.error";
+    Cpu_DgParallelTemperingError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_DgParallelTemperingError);
+    PyModule_AddObject(m, "error", Cpu_DgParallelTemperingError);
+}
@@ -0,0 +1,410 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUDenseGraphPopulationAnnealer.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue,
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_DgPopAnnealerError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_DgPopAnnealerError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+
+template<class real>
+sqd::CPUDenseGraphPopulationAnnealer<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUDenseGraphPopulationAnnealer<real> *>(val);
+}
+
+extern "C"
+PyObject *dg_pop_annealer_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUDenseGraphPopulationAnnealer<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUDenseGraphPopulationAnnealer<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+template<class real>
+void internal_dg_pop_annealer_set_problem(PyObject *objExt, PyObject *objW, int opt) {
+    typedef NpMatrixType<real> NpMatrix;
+    const NpMatrix W(objW);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblem(W, om);
+}
+
+extern "C"
+PyObject *dg_pop_annealer_set_problem(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objW, *dtype;
+    int opt;
+    if (!PyArg_ParseTuple(args, "OOiO", &objExt, &objW, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_pop_annealer_set_problem<double>(objExt, objW, opt);
+    else if (isFloat32(dtype))
+        internal_dg_pop_annealer_set_problem<float>(objExt, objW, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_get_problem_size(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType N, nReplicas;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&N, &nReplicas);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&N, &nReplicas);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("II", N, nReplicas);
+}
+
+extern "C"
+PyObject *dg_pop_annealer_set_solver_preference(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType nReplicas = 0, nSweeps = 0;
+    if (!PyArg_ParseTuple(args, "OIIO", &objExt, &nReplicas, &nSweeps, &dtype))
+        return NULL;
+    if (isFloat64(dtype)) {
+        if (nReplicas != 0)
+            pyobjToCppObj<double>(objExt)->setPopulationSize(nReplicas);
+        if (nSweeps != 0)
+            pyobjToCppObj<double>(objExt)->setNumSweeps(nSweeps);
+    }
+    else if (isFloat32(dtype)) {
+        if (nReplicas != 0)
+            pyobjToCppObj<float>(objExt)->setPopulationSize(nReplicas);
+        if (nSweeps != 0)
+            pyobjToCppObj<float>(objExt)->setNumSweeps(nSweeps);
+    }
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+void internal_dg_pop_annealer_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpVectorType<real> NpVector;
+    NpVector E(objE);
+    E.vec = pyobjToCppObj<real>(objExt)->get_E();
+}
+
+
+extern "C"
+PyObject *dg_pop_annealer_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_pop_annealer_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_dg_pop_annealer_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+/* returns x as (nReplicas, N) array. */
+template<class real>
+PyObject *internal_dg_pop_annealer_get_x(PyObject *objExt) {
+    const sqaod::BitMatrix &x = pyobjToCppObj<real>(objExt)->get_x();
+    NpBitMatrix npX(x.rows, x.cols, NPY_INT8);
+    npX.mat.map() = x.map();
+    return npX.obj;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_pop_annealer_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_dg_pop_annealer_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+template<class real>
+void internal_dg_pop_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUDenseGraphPopulationAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_pop_annealer_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_pop_annealer_randomize_q<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_dg_pop_annealer_randomize_q<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_calculate_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->calculate_E();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->calculate_E();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+extern "C"
+PyObject *dg_pop_annealer_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->finAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->finAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+void internal_dg_pop_annealer_anneal_one_step(PyObject *objExt, PyObject *objBeta) {
+    typedef NpConstScalarType<real> NpConstScalar;
+    NpConstScalar beta(objBeta);
+    sqd::CPUDenseGraphPopulationAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(beta);
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *dg_pop_annealer_anneal_one_step(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objBeta, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objBeta, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_dg_pop_annealer_anneal_one_step<double>(objExt, objBeta);
+    else if (isFloat32(dtype))
+        internal_dg_pop_annealer_anneal_one_step<float>(objExt, objBeta);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+
+template<class real>
+PyObject *internal_dg_pop_annealer_anneal(PyObject *objExt, double betaFin, int nSteps) {
+    sqd::CPUDenseGraphPopulationAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    real E;
+    sqd::Bits x;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x, (real)betaFin, nSteps);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpBitVector npX(x.size, NPY_INT8);
+    npX.vec = x;
+    return Py_BuildValue("NN", newScalarObj(E), npX.obj);
+}
+
+extern "C"
+PyObject *dg_pop_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double betaFin;
+    int nSteps;
+    if (!PyArg_ParseTuple(args, "OdiO", &objExt, &betaFin, &nSteps, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_dg_pop_annealer_anneal<double>(objExt, betaFin, nSteps);
+    else if (isFloat32(dtype))
+        return internal_dg_pop_annealer_anneal<float>(objExt, betaFin, nSteps);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+extern "C"
+PyObject *dg_pop_annealer_get_num_families(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType nFamilies;
+    if (isFloat64(dtype))
+        nFamilies = pyobjToCppObj<double>(objExt)->getNumFamilies();
+    else if (isFloat32(dtype))
+        nFamilies = pyobjToCppObj<float>(objExt)->getNumFamilies();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("I", nFamilies);
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_dg_pop_annealer_methods[] = {
+	{"new_annealer", dg_pop_annealer_create, METH_VARARGS},
+	{"delete_annealer", dg_pop_annealer_delete, METH_VARARGS},
+	{"rand_seed", dg_pop_annealer_rand_seed, METH_VARARGS},
+	{"set_problem", dg_pop_annealer_set_problem, METH_VARARGS},
+	{"get_problem_size", dg_pop_annealer_get_problem_size, METH_VARARGS},
+	{"set_solver_preference", dg_pop_annealer_set_solver_preference, METH_VARARGS},
+	{"set_num_threads", dg_pop_annealer_set_num_threads, METH_VARARGS},
+	{"get_E", dg_pop_annealer_get_E, METH_VARARGS},
+	{"get_x", dg_pop_annealer_get_x, METH_VARARGS},
+	{"randomize_q", dg_pop_annealer_radomize_q, METH_VARARGS},
+	{"calculate_E", dg_pop_annealer_calculate_E, METH_VARARGS},
+	{"init_anneal", dg_pop_annealer_init_anneal, METH_VARARGS},
+	{"fin_anneal", dg_pop_annealer_fin_anneal, METH_VARARGS},
+	{"anneal_one_step", dg_pop_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", dg_pop_annealer_anneal, METH_VARARGS},
+	{"get_num_families", dg_pop_annealer_get_num_families, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_dg_pop_annealer(void) {
+    PyObject *m;
+
+    m = Py_InitModule("cpu_dg_pop_annealer", cpu_dg_pop_annealer_methods);
+    import_array();
+    if (m == NULL)
+        return;
+
+    char name[] = "cpu_dg_pop_annealer.error";
+    Cpu_DgPopAnnealerError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_DgPopAnnealerError);
+    PyModule_AddObject(m, "error", Cpu_DgPopAnnealerError);
+}
@@ -0,0 +1,570 @@
+#include <pyglue.h>
+#include <cpu/CPUFormulas.h>
+#include <cpu/CPUSparseGraphAnnealer.h>
+#include <string.h>
+
+
+/* FIXME : remove DONT_REACH_HERE macro */
+
+
+// http://owa.as.wakwak.ne.jp/zope/docs/Python/BindingC/
+// http://scipy-cookbook.readthedocs.io/items/C_Extensions_NumPy_arrays.html
+
+/* NOTE: Value type checks for python objs have been already done in python glue, 
+ * Here we only get entities needed. */
+
+
+static PyObject *Cpu_SgSolverError;
+namespace sqd = sqaod;
+
+
+namespace {
+
+
+
+void setErrInvalidDtype(PyObject *dtype) {
+    PyErr_SetString(Cpu_SgSolverError, "dtype must be numpy.float64 or numpy.float32.");
+}
+
+#define RAISE_INVALID_DTYPE(dtype) {setErrInvalidDtype(dtype); return NULL; }
+
+    
+template<class real>
+sqd::CPUSparseGraphAnnealer<real> *pyobjToCppObj(PyObject *obj) {
+    npy_uint64 val = PyArrayScalar_VAL(obj, UInt64);
+    return reinterpret_cast<sqd::CPUSparseGraphAnnealer<real> *>(val);
+}
+
+extern "C"
+PyObject *sg_annealer_create(PyObject *module, PyObject *args) {
+    PyObject *dtype;
+    void *ext;
+    if (!PyArg_ParseTuple(args, "O", &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        ext = (void*)new sqd::CPUSparseGraphAnnealer<double>();
+    else if (isFloat32(dtype))
+        ext = (void*)new sqd::CPUSparseGraphAnnealer<float>();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    PyObject *obj = PyArrayScalar_New(UInt64);
+    PyArrayScalar_ASSIGN(obj, UInt64, (npy_uint64)ext);
+    return obj;
+}
+
+extern "C"
+PyObject *sg_annealer_delete(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        delete pyobjToCppObj<double>(objExt);
+    else if (isFloat32(dtype))
+        delete pyobjToCppObj<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *sg_annealer_rand_seed(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    unsigned long long seed;
+    if (!PyArg_ParseTuple(args, "OKO", &objExt, &seed, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->seed(seed);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->seed(seed);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+void internal_sg_annealer_set_problem(PyObject *objExt, int N,
+                                      PyObject *objRowPtr, PyObject *objColIdx, PyObject *objValues,
+                                      int opt) {
+    typedef NpVectorType<real> NpVector;
+    typedef NpVectorType<sqd::IdxType> NpIdxVector;
+    NpIdxVector rowPtr(objRowPtr), colIdx(objColIdx);
+    NpVector values(objValues);
+    sqd::OptimizeMethod om = (opt == 0) ? sqd::optMinimize : sqd::optMaximize;
+    pyobjToCppObj<real>(objExt)->setProblem(N, rowPtr, colIdx, values, om);
+}
+    
+extern "C"
+PyObject *sg_annealer_set_problem(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objRowPtr, *objColIdx, *objValues, *dtype;
+    int N, opt;
+    if (!PyArg_ParseTuple(args, "OiOOOiO", &objExt, &N, &objRowPtr, &objColIdx, &objValues, &opt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_set_problem<double>(objExt, N, objRowPtr, objColIdx, objValues, opt);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_set_problem<float>(objExt, N, objRowPtr, objColIdx, objValues, opt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+extern "C"
+PyObject *sg_annealer_get_num_non_zeros(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType nnz;
+    if (isFloat64(dtype))
+        nnz = pyobjToCppObj<double>(objExt)->getNumNonZeros();
+    else if (isFloat32(dtype))
+        nnz = pyobjToCppObj<float>(objExt)->getNumNonZeros();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("I", nnz);
+}
+    
+extern "C"
+PyObject *sg_annealer_get_problem_size(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    sqaod::SizeType N, m;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->getProblemSize(&N, &m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->getProblemSize(&N, &m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    return Py_BuildValue("II", N, m);
+}
+    
+extern "C"
+PyObject *sg_annealer_set_solver_preference(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    sqaod::SizeType m = 0;
+    if (!PyArg_ParseTuple(args, "OIO", &objExt, &m, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumTrotters(m);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumTrotters(m);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *sg_annealer_select_algorithm(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int algo;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &algo, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->selectAlgorithm((sqd::Algorithm)algo);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *sg_annealer_set_sweep_order(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int order;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &order, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setSweepOrder((sqd::SweepOrder)order);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+extern "C"
+PyObject *sg_annealer_set_num_threads(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    int nThreads;
+    if (!PyArg_ParseTuple(args, "OiO", &objExt, &nThreads, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->setNumThreads(nThreads);
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->setNumThreads(nThreads);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_sg_annealer_get_E(PyObject *objExt, PyObject *objE) {
+    typedef NpVectorType<real> NpVector;
+    NpVector E(objE);
+    sqd::CPUSparseGraphAnnealer<real> *ext = pyobjToCppObj<real>(objExt);
+    E.vec = ext->get_E();
+}
+
+    
+extern "C"
+PyObject *sg_annealer_get_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objE, *dtype;
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objE, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_get_E<double>(objExt, objE);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_get_E<float>(objExt, objE);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+template<class real>
+PyObject *internal_sg_annealer_get_x(PyObject *objExt) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+
+    sqaod::SizeType N, m;
+    ann->getProblemSize(&N, &m);
+    const sqaod::BitsArray &xList = ann->get_x();
+    PyObject *list = PyList_New(xList.size());
+    for (size_t idx = 0; idx < xList.size(); ++idx) {
+        NpBitVector x(N, NPY_INT8);
+        x.vec = xList[idx];
+        PyList_SET_ITEM(list, idx, x.obj);
+    }
+    return list;
+}
+    
+extern "C"
+PyObject *sg_annealer_get_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_sg_annealer_get_x<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_sg_annealer_get_x<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+
+template<class real>
+void internal_sg_annealer_set_x(PyObject *objExt, PyObject *objX) {
+    NpBitVector x(objX);
+    pyobjToCppObj<real>(objExt)->set_x(x);
+}
+
+extern "C"
+PyObject *sg_annealer_set_x(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objX, *dtype;
+    
+    if (!PyArg_ParseTuple(args, "OOO", &objExt, &objX, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_set_x<double>(objExt, objX);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_set_x<float>(objExt, objX);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+
+
+
+
+template<class real>
+void internal_sg_annealer_get_hJc(PyObject *objExt, PyObject *objH,
+                                  PyObject *objRowPtr, PyObject *objColIdx, PyObject *objValues,
+                                  PyObject *objC) {
+    typedef NpVectorType<real> NpVector;
+    typedef NpVectorType<sqd::IdxType> NpIdxVector;
+    typedef NpScalarRefType<real> NpScalarRef;
+
+    NpVector h(objH), values(objValues);
+    NpIdxVector rowPtr(objRowPtr), colIdx(objColIdx);
+    NpScalarRef c(objC);
+    
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    ann->get_hJc(&h, &rowPtr, &colIdx, &values, &c);
+}
+    
+    
+extern "C"
+PyObject *sg_annealer_get_hJc(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objH, *objRowPtr, *objColIdx, *objValues, *objC, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOOOOO", &objExt, &objH, &objRowPtr, &objColIdx, &objValues, &objC, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_get_hJc<double>(objExt, objH, objRowPtr, objColIdx, objValues, objC);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_get_hJc<float>(objExt, objH, objRowPtr, objColIdx, objValues, objC);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+    
+template<class real>
+PyObject *internal_sg_annealer_get_q(PyObject *objExt) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+
+    sqaod::SizeType N, m;
+    ann->getProblemSize(&N, &m);
+    const sqaod::BitsArray &qList = ann->get_q();
+    PyObject *list = PyList_New(qList.size());
+    for (size_t idx = 0; idx < qList.size(); ++idx) {
+        NpBitVector q(N, NPY_INT8);
+        q.vec = qList[idx];
+        PyList_SET_ITEM(list, idx, q.obj);
+    }
+    return list;
+}
+    
+extern "C"
+PyObject *sg_annealer_get_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_sg_annealer_get_q<double>(objExt);
+    else if (isFloat32(dtype))
+        return internal_sg_annealer_get_q<float>(objExt);
+    RAISE_INVALID_DTYPE(dtype);
+}
+    
+template<class real>
+void internal_sg_annealer_randomize_q(PyObject *objExt) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->randomize_q();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *sg_annealer_radomize_q(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_randomize_q<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_randomize_q<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_sg_annealer_calculate_E(PyObject *objExt) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->calculate_E();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *sg_annealer_calculate_E(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_calculate_E<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_calculate_E<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+        
+extern "C"
+PyObject *sg_annealer_init_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        pyobjToCppObj<double>(objExt)->initAnneal();
+    else if (isFloat32(dtype))
+        pyobjToCppObj<float>(objExt)->initAnneal();
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+    
+template<class real>
+void internal_sg_annealer_fin_anneal(PyObject *objExt) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->finAnneal();
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *sg_annealer_fin_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    if (!PyArg_ParseTuple(args, "OO", &objExt, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_fin_anneal<double>(objExt);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_fin_anneal<float>(objExt);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+template<class real>
+void internal_sg_annealer_anneal_one_step(PyObject *objExt, PyObject *objG, PyObject *objKT) {
+    typedef NpConstScalarType<real> NpConstScalar;
+    NpConstScalar G(objG), kT(objKT);
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->annealOneStep(G, kT);
+    END_ALLOW_THREADS_CATCH
+}
+
+extern "C"
+PyObject *sg_annealer_anneal_one_step(PyObject *module, PyObject *args) {
+    PyObject *objExt, *objG, *objKT, *dtype;
+    if (!PyArg_ParseTuple(args, "OOOO", &objExt, &objG, &objKT, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        internal_sg_annealer_anneal_one_step<double>(objExt, objG, objKT);
+    else if (isFloat32(dtype))
+        internal_sg_annealer_anneal_one_step<float>(objExt, objG, objKT);
+    else
+        RAISE_INVALID_DTYPE(dtype);
+
+    if (PyErr_Occurred())
+        return NULL;
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+
+
+
+template<class real>
+PyObject *internal_sg_annealer_anneal(PyObject *objExt,
+                                      double Ginit, double Gfin, double kT, double tau, int nRepeat) {
+    sqd::CPUSparseGraphAnnealer<real> *ann = pyobjToCppObj<real>(objExt);
+    sqaod::SizeType N, m;
+    ann->getProblemSize(&N, &m);
+
+    real E;
+    sqd::Bits x;
+    BEGIN_ALLOW_THREADS_CATCH
+    ann->anneal(&E, &x, (real)Ginit, (real)Gfin, (real)kT, (real)tau, nRepeat);
+    END_ALLOW_THREADS_CATCH
+    if (PyErr_Occurred())
+        return NULL;
+
+    NpBitVector npX(N, NPY_INT8);
+    npX.vec = x;
+    return Py_BuildValue("NN", newScalarObj(E), npX.obj);
+}
+
+extern "C"
+PyObject *sg_annealer_anneal(PyObject *module, PyObject *args) {
+    PyObject *objExt, *dtype;
+    double Ginit, Gfin, kT, tau;
+    int nRepeat;
+    if (!PyArg_ParseTuple(args, "OddddiO", &objExt, &Ginit, &Gfin, &kT, &tau, &nRepeat, &dtype))
+        return NULL;
+    if (isFloat64(dtype))
+        return internal_sg_annealer_anneal<double>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    else if (isFloat32(dtype))
+        return internal_sg_annealer_anneal<float>(objExt, Ginit, Gfin, kT, tau, nRepeat);
+    RAISE_INVALID_DTYPE(dtype);
+}
+
+}
+
+
+
+
+static
+PyMethodDef cpu_sg_annealer_methods[] = {
+	{"new_annealer", sg_annealer_create, METH_VARARGS},
+	{"delete_annealer", sg_annealer_delete, METH_VARARGS},
+	{"rand_seed", sg_annealer_rand_seed, METH_VARARGS},
+	{"set_problem", sg_annealer_set_problem, METH_VARARGS},
+	{"get_problem_size", sg_annealer_get_problem_size, METH_VARARGS},
+	{"get_num_non_zeros", sg_annealer_get_num_non_zeros, METH_VARARGS},
+	{"set_solver_preference", sg_annealer_set_solver_preference, METH_VARARGS},
+	{"select_algorithm", sg_annealer_select_algorithm, METH_VARARGS},
+	{"set_sweep_order", sg_annealer_set_sweep_order, METH_VARARGS},
+	{"set_num_threads", sg_annealer_set_num_threads, METH_VARARGS},
+	{"get_E", sg_annealer_get_E, METH_VARARGS},
+	{"get_x", sg_annealer_get_x, METH_VARARGS},
+	{"set_x", sg_annealer_set_x, METH_VARARGS},
+	{"get_hJc", sg_annealer_get_hJc, METH_VARARGS},
+	{"get_q", sg_annealer_get_q, METH_VARARGS},
+	{"randomize_q", sg_annealer_radomize_q, METH_VARARGS},
+	{"calculate_E", sg_annealer_calculate_E, METH_VARARGS},
+	{"init_anneal", sg_annealer_init_anneal, METH_VARARGS},
+	{"fin_anneal", sg_annealer_fin_anneal, METH_VARARGS},
+	{"anneal_one_step", sg_annealer_anneal_one_step, METH_VARARGS},
+	{"anneal", sg_annealer_anneal, METH_VARARGS},
+	{NULL},
+};
+
+
+
+extern "C"
+PyMODINIT_FUNC
+initcpu_sg_annealer(void) {
+    PyObject *m;
+    
+    m = Py_InitModule("cpu_sg_annealer", cpu_sg_annealer_methods);
+    import_array();
+    if (m == NULL)
+        return;
+    
+    char name[] = "cpu_sg_solver.error";
+    Cpu_SgSolverError = PyErr_NewException(name, NULL, NULL);
+    Py_INCREF(Cpu_SgSolverError);
+    PyModule_AddObject(m, "error", Cpu_SgSolverError);
+}
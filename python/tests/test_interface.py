@@ -72,7 +72,267 @@ class TestCommon(unittest.TestCase):
         self.run_searcher(ann)
         ann = sq.cpu.bipartite_graph_bf_solver(b0, b1, W, sq.maximize, np.float64)
         self.run_searcher(ann)
-        
+
+    def test_dense_graph_annealer_algorithms(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        for algo in [sq.algo_naive, sq.algo_local_field, sq.algo_coloring] :
+            ann = sq.cpu.dense_graph_annealer(W, sq.minimize, 4, np.float64)
+            ann.select_algorithm(algo)
+            ann.set_num_threads(2)
+            self.run_annealer(ann)
+
+    def test_bipartite_graph_annealer_algorithms(self):
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        for algo in [sq.algo_naive, sq.algo_coloring] :
+            ann = sq.cpu.bipartite_graph_annealer(b0, b1, W, sq.minimize, 3, np.float64)
+            ann.select_algorithm(algo)
+            ann.set_num_threads(2)
+            self.run_annealer(ann)
+
+    def test_bit_packed_annealers(self):
+        # bit-packed spins require integral W.
+        W = np.round(dense_graph_random(8, dtype=np.float64) * 8.)
+        ann = sq.cpu.dense_graph_annealer(W, sq.minimize, 4, np.float64)
+        ann.select_algorithm(sq.algo_bit_packed)
+        self.run_annealer(ann)
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        b0, b1, W = np.round(b0 * 8.), np.round(b1 * 8.), np.round(W * 8.)
+        ann = sq.cpu.bipartite_graph_annealer(b0, b1, W, sq.minimize, 2, np.float64)
+        ann.select_algorithm(sq.algo_bit_packed)
+        self.run_annealer(ann)
+
+    def test_boltzmann_table(self):
+        # integral W anneals with tabulated thresholds.  A non-integral perturbation,
+        # far below the resolution of thresholds, disables the table.
+        W = np.round(dense_graph_random(8, dtype=np.float64) * 4.)
+        Wp = W + 1.e-9 * (1. - np.identity(8))
+        for algo in [sq.algo_naive, sq.algo_local_field, sq.algo_coloring] :
+            x = []
+            for Wi in [W, Wp] :
+                ann = sq.cpu.dense_graph_annealer(Wi, sq.minimize, 32, np.float64)
+                ann.select_algorithm(algo)
+                ann.rand_seed(0)
+                ann.init_anneal()
+                ann.randomize_q()
+                # high kT, thus x depends on all thresholds.
+                for step in range(10) :
+                    ann.anneal_one_step(1., 1.)
+                ann.fin_anneal()
+                x.append(np.array(ann.get_x()))
+            self.assertTrue(np.all(x[0] == x[1]))
+
+    def test_sparse_graph_annealer(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        for algo in [sq.algo_naive, sq.algo_local_field, sq.algo_coloring] :
+            ann = sq.cpu.sparse_graph_annealer(W, sq.minimize, 4, np.float64)
+            ann.select_algorithm(algo)
+            self.run_annealer(ann)
+            E, x = ann.anneal(n_repeat = 2)
+            self.assertTrue(np.allclose(E, sq.py.formulas.dense_graph_calculate_E(W, x)))
+
+    def test_sweep_orders(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        b0, b1, Wb = bipartite_graph_random(4, 3, np.float64)
+        for order in [sq.sweep_random, sq.sweep_sequential, sq.sweep_permutation, sq.sweep_blocked] :
+            for algo in [sq.algo_naive, sq.algo_local_field, sq.algo_coloring] :
+                ann = sq.cpu.dense_graph_annealer(W, sq.minimize, 4, np.float64)
+                ann.select_algorithm(algo)
+                ann.set_sweep_order(order)
+                self.run_annealer(ann)
+            ann = sq.cpu.sparse_graph_annealer(W, sq.minimize, 4, np.float64)
+            ann.set_sweep_order(order)
+            self.run_annealer(ann)
+            ann = sq.cpu.bipartite_graph_annealer(b0, b1, Wb, sq.minimize, 2, np.float64)
+            ann.set_sweep_order(order)
+            self.run_annealer(ann)
+
+    def test_batch_annealers(self):
+        W = np.array([dense_graph_random(8, dtype=np.float64) for p in range(3)])
+        ann = sq.cpu.dense_graph_batch_annealer(W, sq.minimize, 4, np.float64)
+        E, x = ann.anneal(n_repeat = 2)
+        self.assertEqual(x.shape, (3, 8))
+        for p in range(3) :
+            self.assertTrue(np.allclose(E[p], sq.py.formulas.dense_graph_calculate_E(W[p], x[p])))
+        self.run_annealer(ann)
+        self.assertEqual(ann.get_E().shape, (3, 4))
+        self.assertEqual(ann.get_x().shape, (3, 4, 8))
+
+        problems = [bipartite_graph_random(4, 3, np.float64) for p in range(3)]
+        b0, b1, W = [np.array(v) for v in zip(*problems)]
+        ann = sq.cpu.bipartite_graph_batch_annealer(b0, b1, W, sq.minimize, 2, np.float64)
+        E, x0, x1 = ann.anneal(n_repeat = 2)
+        for p in range(3) :
+            self.assertTrue(np.allclose(E[p], sq.py.formulas.bipartite_graph_calculate_E(b0[p], b1[p], W[p], x0[p], x1[p])))
+        self.run_annealer(ann)
+
+    def test_dense_graph_multispin_annealer(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        ann = sq.cpu.dense_graph_multispin_annealer(W, sq.minimize, 4, np.float64)
+        self.run_annealer(ann)
+        E = ann.get_E()
+        self.assertEqual(E.shape, (ann.n_replicas, 4))
+        for replica in [0, ann.n_replicas - 1] :
+            x = ann.get_x(replica)
+            self.assertEqual(len(x), 4)
+            self.assertTrue(np.allclose(ann.get_E(replica)[0], sq.py.formulas.dense_graph_calculate_E(W, x[0])))
+
+    def test_parallel_tempering(self):
+        kT = np.logspace(np.log10(0.05), np.log10(2.), 6)
+        W = dense_graph_random(8, dtype=np.float64)
+        pt = sq.cpu.dense_graph_parallel_tempering(W, sq.minimize, kT, np.float64)
+        pt.run(20, 2)
+        pt.fin_anneal()
+        E, x = pt.get_best()
+        self.assertTrue(np.allclose(E, sq.py.formulas.dense_graph_calculate_E(W, x)))
+        self.assertEqual(len(pt.get_x()), 6)
+        self.assertEqual(pt.get_swap_acceptance_rates().shape, (5, ))
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        pt = sq.cpu.bipartite_graph_parallel_tempering(b0, b1, W, sq.minimize, kT, np.float64)
+        pt.run(20, 2)
+        pt.fin_anneal()
+        E, x0, x1 = pt.get_best()
+        self.assertTrue(np.allclose(E, sq.py.formulas.bipartite_graph_calculate_E(b0, b1, W, x0, x1)))
+
+    def test_dense_graph_population_annealer(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        for optimize in [sq.minimize, sq.maximize] :
+            ann = sq.cpu.dense_graph_population_annealer(W, optimize, 64, np.float64)
+            E, x = ann.anneal(beta_fin = 5., n_steps = 10)
+            self.assertTrue(np.allclose(E, sq.py.formulas.dense_graph_calculate_E(W, x)))
+            self.assertEqual(ann.get_E().shape, (64, ))
+            self.assertEqual(ann.get_x().shape, (64, 8))
+
+    def test_stopping_policy(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        ann = sq.cpu.dense_graph_annealer(W, sq.minimize, 4, np.float64)
+        ann.set_stopping_policy(n_frozen_steps = 10, track_energy = True)
+        E, x = ann.anneal(Ginit = 5., Gfin = 0.001, tau = 0.99, n_repeat = 1)
+        stats = ann.get_anneal_statistics()
+        self.assertTrue(stats['n_steps'] < int(np.log(0.001 / 5.) / np.log(0.99)))
+        self.assertEqual(len(ann.get_acceptance_rates()), stats['n_steps'])
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        ann = sq.cpu.bipartite_graph_annealer(b0, b1, W, sq.minimize, 4, np.float64)
+        ann.set_stopping_policy(n_frozen_steps = 10)
+        ann.anneal(Ginit = 5., Gfin = 0.001, tau = 0.99, n_repeat = 1)
+        self.assertTrue(ann.get_anneal_statistics()['n_frozen_steps'] <= 10)
+
+    def test_sa_annealers(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        for optimize in [sq.minimize, sq.maximize] :
+            ann = sq.cpu.dense_graph_sa_annealer(W, optimize, 4, np.float64)
+            self.run_annealer(ann)
+            self.assertEqual(ann.get_E().shape, (4, ))
+            E, x = ann.anneal(kT = 0., tau = 0.9, n_repeat = 2)
+            self.assertTrue(np.allclose(E, sq.py.formulas.dense_graph_calculate_E(W, x)))
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        for optimize in [sq.minimize, sq.maximize] :
+            ann = sq.cpu.bipartite_graph_sa_annealer(b0, b1, W, optimize, 4, np.float64)
+            self.run_annealer(ann)
+            E, x = ann.anneal(kT = 0., tau = 0.9, n_repeat = 2)
+            self.assertTrue(np.allclose(E, sq.py.formulas.bipartite_graph_calculate_E(b0, b1, W, x[0], x[1])))
+
+    def test_bf_solver_gray_code(self):
+        # x of 4 or 5 ones are degenerate in the second W.
+        Ws = [dense_graph_random(12, dtype=np.float64),
+              np.full((8, 8), 4., np.float64) - 36. * np.identity(8)]
+        for W in Ws :
+            N = W.shape[0]
+            for optimize in [sq.minimize, sq.maximize] :
+                solver = sq.cpu.dense_graph_bf_solver(W, optimize, np.float64)
+                solver.search()
+                Ebatch, xbatch = solver.get_E(), set(tuple(x) for x in solver.get_x())
+                solver.select_algorithm(sq.algo_gray_code)
+                solver.search()
+                self.assertTrue(np.allclose(solver.get_E(), Ebatch))
+                self.assertEqual(set(tuple(x) for x in solver.get_x()), xbatch)
+                # one range walks over the resync interval of gray codes.
+                solver.init_search()
+                solver.search_range(0, 1 << N)
+                solver.fin_search()
+                self.assertTrue(np.allclose(solver.get_E(), Ebatch))
+                self.assertEqual(set(tuple(x) for x in solver.get_x()), xbatch)
+
+    def test_bf_solver_top_k(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        for optimize in [sq.minimize, sq.maximize] :
+            solver = sq.cpu.dense_graph_bf_solver(W, optimize, np.float64)
+            solver.set_top_k(10)
+            solver.search()
+            E, x = solver.get_E(), np.array(solver.get_x())
+            self.assertEqual(len(E), 10)
+            self.assertTrue(np.allclose(E, sq.py.formulas.dense_graph_batch_calculate_E(W, x)))
+            self.assertTrue(np.all(np.diff(E * optimize.sign) >= 0.))
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        solver = sq.cpu.bipartite_graph_bf_solver(b0, b1, W, sq.minimize, np.float64)
+        solver.set_top_k(10)
+        solver.search()
+        E = solver.get_E()
+        self.assertEqual(len(E), 10)
+        for Ei, (x0, x1) in zip(E, solver.get_x()) :
+            self.assertTrue(np.allclose(Ei, sq.py.formulas.bipartite_graph_calculate_E(b0, b1, W, x0, x1)))
+
+    def test_bf_solver_min_states_limit(self):
+        # x of 4 or 5 ones are degenerate at E = -80.
+        W = np.full((8, 8), 4., np.float64) - 36. * np.identity(8)
+        solver = sq.cpu.dense_graph_bf_solver(W, sq.minimize, np.float64)
+        solver.set_max_n_min_states(16)
+        solver.search()
+        self.assertEqual(solver.get_n_min_states(), 126)
+        self.assertEqual(len(solver.get_x()), 16)
+        self.assertTrue(np.allclose(solver.get_E(), -80.))
+        self.assertEqual(solver.get_min_E(), -80.)
+        # count-only mode gives the minimum E by get_min_E().
+        solver.set_max_n_min_states(0)
+        solver.search()
+        self.assertEqual(solver.get_n_min_states(), 126)
+        self.assertEqual(len(solver.get_x()), 0)
+        self.assertEqual(len(solver.get_E()), 0)
+        self.assertEqual(solver.get_min_E(), -80.)
+
+        b0, b1, W = np.zeros(4), np.zeros(3), np.zeros((3, 4))
+        solver = sq.cpu.bipartite_graph_bf_solver(b0, b1, W, sq.minimize, np.float64)
+        solver.set_max_n_min_states(16)
+        solver.search()
+        self.assertEqual(solver.get_n_min_states(), 128)
+        self.assertEqual(len(solver.get_x()), 16)
+
+    def test_bf_solver_too_many_bits(self):
+        # errors of searches without the GIL are raised, not aborting the interpreter.
+        solver = sq.cpu.dense_graph_bf_solver(np.zeros((64, 64)), sq.minimize, np.float64)
+        self.assertRaises(RuntimeError, solver.search)
+        self.assertRaises(RuntimeError, solver.init_search)
+
+    def test_bf_solver_clamped_bits(self):
+        W = dense_graph_random(8, dtype=np.float64)
+        mask = np.array([1, 0, 0, 1, 0, 1, 0, 0], np.int8)
+        x = np.array([1, 0, 0, 0, 0, 1, 0, 0], np.int8)
+        xs = np.where(mask, x, sq.create_bits_sequence(range(1 << 8), 8))
+        Emin = np.min(sq.py.formulas.dense_graph_batch_calculate_E(W, xs))
+        solver = sq.cpu.dense_graph_bf_solver(W, sq.minimize, np.float64)
+        solver.set_clamped_bits(mask, x)
+        solver.search()
+        self.assertTrue(np.allclose(solver.get_E()[0], Emin))
+        for xmin in solver.get_x() :
+            self.assertTrue(np.all(xmin[mask != 0] == x[mask != 0]))
+            self.assertTrue(np.allclose(sq.py.formulas.dense_graph_calculate_E(W, xmin), Emin))
+
+        b0, b1, W = bipartite_graph_random(4, 3, np.float64)
+        mask0, x0 = np.array([1, 0, 0, 1], np.int8), np.array([1, 0, 0, 0], np.int8)
+        mask1, x1 = np.array([0, 1, 0], np.int8), np.array([0, 1, 0], np.int8)
+        solver = sq.cpu.bipartite_graph_bf_solver(b0, b1, W, sq.minimize, np.float64)
+        solver.set_clamped_bits(mask0, x0, mask1, x1)
+        solver.search()
+        for xmin0, xmin1 in solver.get_x() :
+            self.assertTrue(np.all(xmin0[mask0 != 0] == x0[mask0 != 0]))
+            self.assertTrue(np.all(xmin1[mask1 != 0] == x1[mask1 != 0]))
+            self.assertTrue(np.allclose(sq.py.formulas.bipartite_graph_calculate_E(b0, b1, W, xmin0, xmin1),
+                                        solver.get_E()[0]))
+
 if __name__ == '__main__':
     np.random.seed(0)
     unittest.main()